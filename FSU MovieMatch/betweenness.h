@@ -0,0 +1,233 @@
+/*
+    betweenness.h
+    Andrew J Wood
+    COP 4530
+
+    Betweenness centrality by Brandes' algorithm: the score of v is the sum,
+    over pairs of target vertices s, t other than v, of the fraction of
+    shortest s-t paths that pass through v.  Every vertex may lie on a path;
+    only targets count as path ends.  With every vertex a target this is the
+    usual definition; MovieMatch uses the actors, so movies and actors alike
+    are scored by the actor-to-actor paths through them.
+
+    One source s costs one BFSurvey from s plus two passes over the reached
+    vertices, in discovery order (the survey's Order()) and in reverse.  As in
+    spaths.h, the shortest-path DAG is implicit in the distances:
+
+        sigma[v] = sum of sigma[u] over neighbors u one closer to s
+        delta[v] = sum over neighbors w one farther from s of
+                   sigma[v] / sigma[w] * (target(w) + delta[w])
+
+    and delta[v] is added to the score of v.
+
+    Threads pull sources from a shared counter.  Each owns its survey, whose
+    queue holds the order, sigma and delta arrays, and its own score accumulator, which is
+    added to the result once when the thread runs out of sources; nothing
+    is shared during a traversal and the graph is never copied.
+
+    Sampling: with samples > 0, that many distinct sources are drawn from
+    the targets (seeded, so repeatable) and the sums are scaled by
+    targets / samples, an unbiased estimate of the exact scores.
+
+    The graph is undirected, so each pair is seen from both ends and the
+    scores are halved.
+
+    Note that the code is self-documenting.
+ */
+
+#ifndef BETWEENNESS_H
+#define BETWEENNESS_H
+
+#include <cstdlib>
+#include <cstdint>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector.h>
+#include <gheap.h>
+#include <xran.h>
+#include <bfsurvey.h>
+
+namespace fsu {
+
+    template < typename N >
+    struct Betweenness
+    {
+        N       vertex_;
+        double  score_;
+
+        //orders by decreasing score, so the best come first after sorting
+        bool    operator < (const Betweenness & b) const
+        {
+            return score_ > b.score_ || (score_ == b.score_ && vertex_ < b.vertex_);
+        }
+    };
+
+    //shared state of one BetweennessCentrality run
+    template < class G, class P >
+    class BetweennessRun
+    {
+    public:
+
+        typedef typename G::Vertex              Vertex;
+        typedef typename G::AdjIterator         AdjIterator;
+
+        BetweennessRun (const G & g, P & target, const fsu::Vector<Vertex> & sources, fsu::Vector<double> & score)
+        :   g_(g), target_(target), sources_(sources), score_(score), next_(0), mutex_()
+        {}
+
+        void    Work    (); //one thread's loop
+
+    private:
+
+        const G &                   g_;
+        P &                         target_;
+        const fsu::Vector<Vertex> & sources_;
+        fsu::Vector<double> &       score_;
+        std::atomic<size_t>         next_;  //next source to hand out
+        std::mutex                  mutex_; //guards score_ while a thread adds its accumulator
+    };
+
+    template < class G, class P >
+    void BetweennessRun<G,P>::Work ()
+    {
+        size_t n = g_.VrtxSize();
+        fsu::BFSurvey<G> bfs(g_);
+        bfs.traceQue = 0;
+        const fsu::Vector<Vertex> & distance = bfs.Distance();
+        fsu::Vector<double> sigma(n, 0.0), delta(n, 0.0), score(n, 0.0);
+        AdjIterator i;
+
+        for (size_t j = next_++; j < sources_.Size(); j = next_++)
+        {
+            Vertex s = sources_[j];
+            bfs.Reset();
+            bfs.Search(s);
+
+            const Vertex * order = bfs.Order();
+            size_t reached = bfs.Reached();
+
+            sigma[s] = 1.0;
+            for (size_t k = 1; k < reached; ++k)
+            {
+                Vertex v = order[k];
+                double c = 0.0;
+                for (i = g_.Begin(v); i != g_.End(v); ++i)
+                {
+                    if (distance[*i] + 1 == distance[v])
+                        c += sigma[*i];
+                }
+                sigma[v] = c;
+            }
+
+            //once v is scored, delta[v] is replaced by (target(v) + delta[v]) / sigma[v],
+            //the factor its predecessors need, so there is one division per vertex, not per edge
+            for (size_t k = reached; k > 0; --k)
+            {
+                Vertex v = order[k-1];
+                double d = 0.0;
+                for (i = g_.Begin(v); i != g_.End(v); ++i)
+                {
+                    if (distance[*i] == distance[v] + 1)
+                        d += delta[*i];
+                }
+                d *= sigma[v];
+                if (v != s)
+                    score[v] += d;
+                delta[v] = (target_(v) ? 1.0 + d : d) / sigma[v];
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (size_t v = 0; v < n; ++v)
+            score_[v] += score[v];
+    }
+
+    //score[v] = betweenness of v over paths between target vertices; samples = 0 is exact,
+    //otherwise an estimate from that many random sources; threads = 0 uses every core
+    template < class G, class P >
+    void BetweennessCentrality (const G & g, P & target, fsu::Vector<double> & score,
+                                size_t samples = 0, uint64_t seed = 0, size_t threads = 0)
+    {
+        typedef typename G::Vertex Vertex;
+        size_t n = g.VrtxSize();
+        score.SetSize(n);
+        for (size_t v = 0; v < n; ++v)
+            score[v] = 0.0;
+
+        fsu::Vector<Vertex> sources;
+        for (Vertex v = 0; v < n; ++v)
+        {
+            if (target(v))
+                sources.PushBack(v);
+        }
+        size_t targets = sources.Size();
+        if (samples > 0 && samples < targets)
+        {
+            //the first samples entries of a partial Fisher-Yates shuffle
+            fsu::Random_uint64_t random(seed);
+            for (size_t k = 0; k < samples; ++k)
+                fsu::Swap(sources[k], sources[(size_t)random(k, targets)]);
+            sources.SetSize(samples);
+        }
+        if (sources.Size() == 0)
+            return;
+
+        if (threads == 0)
+            threads = std::thread::hardware_concurrency();
+        if (threads == 0)
+            threads = 1;
+        if (threads > sources.Size())
+            threads = sources.Size();
+        BetweennessRun<G,P> run(g, target, sources, score);
+        fsu::Vector<std::thread*> pool;
+        for (size_t t = 1; t < threads; ++t)
+            pool.PushBack(new std::thread(&BetweennessRun<G,P>::Work, &run));
+        run.Work();
+        for (size_t t = 0; t < pool.Size(); ++t)
+        {
+            pool[t]->join();
+            delete pool[t];
+        }
+
+        double scale = 0.5 * (double)targets / (double)sources.Size();
+        for (size_t v = 0; v < n; ++v)
+            score[v] *= scale;
+    }
+
+    //the k highest scores, best first
+    template < class G, class P >
+    void TopBetweenness (const G & g, size_t k, P & target, fsu::Vector< Betweenness<typename G::Vertex> > & top,
+                         size_t samples = 0, uint64_t seed = 0, size_t threads = 0)
+    {
+        typedef typename G::Vertex Vertex;
+        top.Clear();
+        if (k == 0)
+            return;
+        fsu::Vector<double> score;
+        BetweennessCentrality(g, target, score, samples, seed, threads);
+
+        //max heap of the best k: its top is the worst of them
+        Betweenness<Vertex> b;
+        for (Vertex v = 0; v < score.Size(); ++v)
+        {
+            b.vertex_ = v;
+            b.score_ = score[v];
+            if (top.Size() < k)
+            {
+                top.PushBack(b);
+                fsu::g_push_heap(top.Begin(), top.End());
+            }
+            else if (b < top[0])
+            {
+                fsu::g_pop_heap(top.Begin(), top.End());
+                top.Back() = b;
+                fsu::g_push_heap(top.Begin(), top.End());
+            }
+        }
+        fsu::g_heap_sort(top.Begin(), top.End());
+    }
+
+} //end namespace fsu
+
+#endif /* BETWEENNESS_H */
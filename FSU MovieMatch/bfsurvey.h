@@ -6,6 +6,17 @@
  This is the header file for the breadth-first survey.  It defines and implements the
  BFSurvery class which is used to do a breadth-first search of a given graph.
  
+ The per-vertex arrays are stored in the graph's Vertex type, so a graph with
+ 32-bit vertex ids gets 32-bit distance, discovery time and parent arrays.  The
+ Vertex type must be able to hold |V| (the null vertex) and 1 + |E| (the
+ infinite distance).
+ 
+ The control queue is an array of |V| vertices with head and tail indices.
+ Search(v) starts it empty and enqueues each vertex at most once, so it never
+ wraps or grows.  The queue is processed one level at a time: the frontier is
+ conQ_[head, levelEnd), and the next frontier is appended behind it.  After
+ Search(v), Order() holds the vertices it reached in discovery order.
+ 
  Note that the code is self-documenting.
  */
 
@@ -13,7 +24,6 @@
 #define BFSURVEY_H
 
 #include <vector.h>
-#include <deque.h>
 
 namespace fsu {
     
@@ -46,7 +56,9 @@ namespace fsu {
         fsu::Vector<Vertex>     dtime_;     //discovery time
         fsu::Vector<Vertex>     parent_;    //for BFS tree
         fsu::Vector<char>       color_;     //using chars 'w' = white, 'g' = grey, 'b' = black
-        fsu::Deque<Vertex>      conQ_;      //control queue
+        fsu::Vector<Vertex>     conQ_;      //control queue, |V| slots
+        size_t                  head_;      //front of queue
+        size_t                  tail_;      //one past back of queue
         
     public:
         
@@ -54,6 +66,8 @@ namespace fsu {
         const fsu::Vector<Vertex>&      DTime       () const {return dtime_;}
         const fsu::Vector<Vertex>&      Parent      () const {return parent_;}
         const fsu::Vector<char>&        Color       () const {return color_;}
+        const Vertex*                   Order       () const {return conQ_.Begin();} //vertices reached by the last Search(v), in discovery order
+        size_t                          Reached     () const {return tail_;}         //number of vertices in Order()
         
         size_t  VrtxSize            () const    {return g_.VrtxSize();}
         size_t  EdgeSize            () const    {return g_.EdgeSize();}
@@ -79,22 +93,24 @@ namespace fsu {
     BFSurvey<G>::BFSurvey (const Graph & g)
     :   g_(g), start_(0), time_(0),
         infinity_   (1+g_.EdgeSize()), forever_(g_.VrtxSize()), null_((Vertex)g_.VrtxSize()),
-        distance_   (g_.VrtxSize(), infinity_),
-        dtime_  (g_.VrtxSize(), forever_),
+        distance_   (g_.VrtxSize(), (Vertex)infinity_),
+        dtime_  (g_.VrtxSize(), (Vertex)forever_),
         parent_ (g_.VrtxSize(), null_),
         color_  (g_.VrtxSize(), 'w'),
-        conQ_()
+        conQ_   (g_.VrtxSize()), head_(0), tail_(0),
+        traceQue(0)
     {}
     
     template < class G >
     BFSurvey<G>::BFSurvey (const Graph & g, Vertex start)
     :   g_(g), start_(start), time_(0),
         infinity_   (1+g_.EdgeSize()), forever_(g_.VrtxSize()), null_((Vertex)g_.VrtxSize()),
-        distance_   (g_.VrtxSize(), infinity_),
-        dtime_  (g_.VrtxSize(), forever_),
+        distance_   (g_.VrtxSize(), (Vertex)infinity_),
+        dtime_  (g_.VrtxSize(), (Vertex)forever_),
         parent_ (g_.VrtxSize(), null_),
         color_  (g_.VrtxSize(), 'w'),
-        conQ_()
+        conQ_   (g_.VrtxSize()), head_(0), tail_(0),
+        traceQue(0)
     {}
 
     template < class G >
@@ -121,36 +137,45 @@ namespace fsu {
     template < class G >
     void BFSurvey<G>::Search (Vertex v)
     {
+        Vertex * q = conQ_.Begin(); //each vertex is enqueued once, so |V| slots suffice
+        head_ = tail_ = 0;
         distance_[v] = 0;
         dtime_[v] = time_++;
-        conQ_.PushBack(v);
+        q[tail_++] = v;
         if (traceQue)
             ShowQue(std::cout);
         color_[v] = 'g';
-        Vertex front;
+        Vertex front, next;
         AdjIterator i;
-        while (!conQ_.Empty())
+        while (head_ < tail_)
         {
-            front = conQ_.Front();
-            //add the unvisited neighbors of front to the queue
-            for (i = g_.Begin(front); i != g_.End(front); ++i)
+            //the frontier is q[head_, levelEnd); its neighbors form the next level
+            size_t levelEnd = tail_;
+            Vertex d = distance_[q[head_]] + 1;
+            while (head_ < levelEnd)
             {
-                if ('w' == color_[*i]) //w = unvisited
+                front = q[head_];
+                //add the unvisited neighbors of front to the queue
+                for (i = g_.Begin(front); i != g_.End(front); ++i)
                 {
-                    distance_[*i] = distance_[front] + 1;
-                    dtime_[*i] = time_++;
-                    parent_[*i] = front;
-                    color_[*i] = 'g';
-                    conQ_.PushBack(*i);
-                    if (traceQue)
-                        ShowQue(std::cout);
+                    next = *i;
+                    if ('w' == color_[next]) //w = unvisited
+                    {
+                        distance_[next] = d;
+                        dtime_[next] = time_++;
+                        parent_[next] = front;
+                        color_[next] = 'g';
+                        q[tail_++] = next;
+                        if (traceQue)
+                            ShowQue(std::cout);
+                    }
                 }
+                //remove front of queue
+                ++head_;
+                if (traceQue)
+                    ShowQue(std::cout);
+                color_[front] = 'b'; //set popped vertex to black
             }
-            //remove front of queue
-            conQ_.PopFront();
-            if (traceQue)
-                ShowQue(std::cout);
-            color_[front] = 'b'; //set popped vertex to black
         }
     }
     
@@ -158,14 +183,15 @@ namespace fsu {
     void BFSurvey<G>::Reset()
     {
         time_ = 0;
-        conQ_.Clear();
+        head_ = tail_ = 0;
         if (color_.Size() != g_.VrtxSize()) //g has changed vertex size, color chosen for comparison
         {
+            conQ_.SetSize (g_.VrtxSize());
             infinity_   = 1 + g_.EdgeSize();
             forever_    = g_.VrtxSize();
-            null_       = g_.VrtxSize();
-            distance_.SetSize (g_.VrtxSize(), infinity_);
-            dtime_.SetSize (g_.VrtxSize(), forever_);
+            null_       = (Vertex)g_.VrtxSize();
+            distance_.SetSize (g_.VrtxSize(), (Vertex)infinity_);
+            dtime_.SetSize (g_.VrtxSize(), (Vertex)forever_);
             parent_.SetSize (g_.VrtxSize(), null_);
             color_.SetSize (g_.VrtxSize() , 'w');
         }
@@ -173,8 +199,8 @@ namespace fsu {
         {
             for (Vertex x = 0; x < g_.VrtxSize(); ++x)
             {
-                distance_[x]    = infinity_;
-                dtime_[x]       = forever_;
+                distance_[x]    = (Vertex)infinity_;
+                dtime_[x]       = (Vertex)forever_;
                 parent_[x]      = null_;
                 color_[x]       = 'w';
             }
@@ -200,10 +226,11 @@ namespace fsu {
     void BFSurvey<G>::ShowQue (std::ostream& os) const
     {
         os << "  ";
-        if (conQ_.Empty())
+        if (head_ == tail_)
             os << "NULL";
         else
-            conQ_.Display(os, ' ');
+            for (size_t k = head_; k < tail_; ++k)
+                os << conQ_[k] << ' ';
         os << '\n';
     }
     
@@ -0,0 +1,266 @@
+/*
+    cgraph.h
+    Andrew J Wood
+    COP 4530
+
+    Defines and implements CompressedGraph, a read-only undirected graph whose
+    adjacency lists are sorted, gap encoded and stored as variable-byte
+    integers in one contiguous byte array.
+
+    Layout of the list for vertex x, starting at bytes_[offset_[x]]:
+
+        degree  gap_0  gap_1 ... gap_{d-1}
+
+    where gap_0 is the first (smallest) neighbor and gap_k is the difference
+    between neighbor k and neighbor k-1.  Every number is written 7 bits per
+    byte, low bits first, with the high bit set on all but the last byte.
+    Neighbor ids of a vertex tend to be close after renumbering (vrtxorder.h),
+    so most gaps take a single byte instead of sizeof(Vertex).
+
+    Offsets are 32 bits, half the size of size_t on the platforms we build for,
+    which limits the encoded lists to 4 GiB; Build refuses larger graphs.
+
+    AdjIterator decodes on the fly and supports exactly what the surveys use:
+    default construction, assignment, ++, * and comparison, so BFSurvey and
+    DFSurvey run on a CompressedGraph unchanged.
+
+    Note that the code is self-documenting.
+ */
+
+#ifndef CGRAPH_H
+#define CGRAPH_H
+
+#include <iostream>
+#include <cstdlib>
+#include <cstdint>
+#include <vector.h>
+#include <gheap.h>
+
+namespace fsu {
+
+    template < typename N >
+    class CompressedGraph
+    {
+    public:
+
+        typedef N               Vertex;
+        typedef unsigned char   Byte;
+
+        class AdjIterator
+        {
+            friend class CompressedGraph<N>;
+        public:
+            AdjIterator () : cur_(nullptr), next_(nullptr), value_(0) {}
+
+            Vertex          operator *  () const {return value_;}
+            AdjIterator &   operator ++ ()
+            {
+                cur_ = next_;
+                value_ += (Vertex)Decode(next_); //reads at most the sentinel past the last list
+                return *this;
+            }
+            bool operator == (const AdjIterator & i) const {return cur_ == i.cur_;}
+            bool operator != (const AdjIterator & i) const {return cur_ != i.cur_;}
+
+        private:
+            const Byte *    cur_;   //start of the current neighbor's encoding
+            const Byte *    next_;  //start of the next neighbor's encoding
+            Vertex          value_; //decoded current neighbor
+        };
+
+        template < class G >
+        bool    Build       (const G & g);  //compresses any graph with the survey interface; 0 = too large
+
+        size_t  VrtxSize    () const {return offset_.Size() - 1;}
+        size_t  EdgeSize    () const {return edgeSize_;}
+        size_t  OutDegree   (Vertex v) const;
+        size_t  InDegree    (Vertex v) const {return OutDegree(v);}
+        bool    HasEdge     (Vertex from, Vertex to) const;
+        size_t  ByteSize    () const; //bytes used by the adjacency representation
+
+        void    Clear       ();
+        void    Dump        (std::ostream & os) const;
+
+        AdjIterator Begin   (Vertex x) const;
+        AdjIterator End     (Vertex x) const;
+
+        CompressedGraph     ();
+        template < class G >
+        explicit CompressedGraph (const G & g);
+
+    private:
+
+        static void     Encode  (size_t n, fsu::Vector<Byte> & bytes);
+        static size_t   Decode  (const Byte *& p);
+
+        fsu::Vector<Byte>       bytes_;     //all lists, followed by one sentinel byte
+        fsu::Vector<uint32_t>   offset_;    //offset_[x] = start of x's list; offset_[VrtxSize()] = end
+        size_t                  edgeSize_;
+
+    }; //end class CompressedGraph
+
+
+    //----
+    //CompressedGraph implementations
+    //----
+
+    template < typename N >
+    CompressedGraph<N>::CompressedGraph () : bytes_(), offset_(1, 0), edgeSize_(0)
+    {
+        bytes_.PushBack(0); //sentinel
+    }
+
+    template < typename N >
+    template < class G >
+    CompressedGraph<N>::CompressedGraph (const G & g) : bytes_(), offset_(1, 0), edgeSize_(0)
+    {
+        Build(g);
+    }
+
+    template < typename N >
+    template < class G >
+    bool CompressedGraph<N>::Build (const G & g)
+    {
+        bytes_.Clear();
+        offset_.SetSize(g.VrtxSize() + 1);
+        edgeSize_ = g.EdgeSize();
+
+        fsu::Vector<Vertex> adj;
+        typename G::AdjIterator i;
+        for (Vertex x = 0; x < g.VrtxSize(); ++x)
+        {
+            adj.Clear();
+            for (i = g.Begin(x); i != g.End(x); ++i)
+                adj.PushBack(*i);
+            fsu::g_heap_sort(adj.Begin(), adj.End());
+
+            if (bytes_.Size() > UINT32_MAX)
+            {
+                std::cerr << " ** CompressedGraph::Build: lists exceed " << UINT32_MAX << " bytes\n";
+                Clear();
+                return 0;
+            }
+            offset_[x] = (uint32_t)bytes_.Size();
+            Encode(adj.Size(), bytes_);
+            Vertex prev = 0;
+            for (size_t k = 0; k < adj.Size(); ++k)
+            {
+                Encode(adj[k] - prev, bytes_);
+                prev = adj[k];
+            }
+        }
+        if (bytes_.Size() > UINT32_MAX)
+        {
+            std::cerr << " ** CompressedGraph::Build: lists exceed " << UINT32_MAX << " bytes\n";
+            Clear();
+            return 0;
+        }
+        offset_[g.VrtxSize()] = (uint32_t)bytes_.Size();
+        bytes_.PushBack(0); //sentinel: ++ on the last neighbor decodes this harmlessly
+        bytes_.SetCapacity(bytes_.Size()); //give back the growth slack
+        return 1;
+    }
+
+    template < typename N >
+    size_t CompressedGraph<N>::OutDegree (Vertex v) const
+    {
+        const Byte * p = bytes_.Begin() + offset_[v];
+        return Decode(p);
+    }
+
+    template < typename N >
+    bool CompressedGraph<N>::HasEdge (Vertex from, Vertex to) const
+    {
+        //lists are sorted, so the scan can stop at the first larger neighbor
+        for (AdjIterator i = Begin(from); i != End(from); ++i)
+        {
+            if (*i == to) return 1;
+            if (*i > to) return 0;
+        }
+        return 0;
+    }
+
+    template < typename N >
+    size_t CompressedGraph<N>::ByteSize () const
+    {
+        return bytes_.Size() * sizeof(Byte) + offset_.Size() * sizeof(uint32_t);
+    }
+
+    template < typename N >
+    void CompressedGraph<N>::Clear ()
+    {
+        bytes_.Clear();
+        bytes_.PushBack(0);
+        offset_.SetSize(1);
+        offset_[0] = 0;
+        edgeSize_ = 0;
+    }
+
+    template < typename N >
+    void CompressedGraph<N>::Dump (std::ostream & os) const
+    {
+        AdjIterator j;
+        for (Vertex v = 0; v < VrtxSize(); ++v)
+        {
+            os << "[" << v << "]->";
+            j = Begin(v);
+            if (j != End(v))
+            {
+                os << *j;
+                ++j;
+            }
+            for (; j != End(v); ++j)
+            {
+                os << ',' << *j;
+            }
+            os << '\n';
+        }
+    }
+
+    template < typename N >
+    typename CompressedGraph<N>::AdjIterator CompressedGraph<N>::Begin (Vertex x) const
+    {
+        AdjIterator i;
+        const Byte * p = bytes_.Begin() + offset_[x];
+        Decode(p); //skip the degree
+        i.cur_ = p;
+        i.value_ = (Vertex)Decode(p);
+        i.next_ = p;
+        return i;
+    }
+
+    template < typename N >
+    typename CompressedGraph<N>::AdjIterator CompressedGraph<N>::End (Vertex x) const
+    {
+        AdjIterator i;
+        i.cur_ = bytes_.Begin() + offset_[x+1];
+        return i;
+    }
+
+    template < typename N >
+    void CompressedGraph<N>::Encode (size_t n, fsu::Vector<Byte> & bytes)
+    {
+        while (n >= 0x80)
+        {
+            bytes.PushBack((Byte)(n | 0x80));
+            n >>= 7;
+        }
+        bytes.PushBack((Byte)n);
+    }
+
+    template < typename N >
+    size_t CompressedGraph<N>::Decode (const Byte *& p)
+    {
+        size_t n = *p & 0x7F;
+        size_t shift = 7;
+        while (*p++ & 0x80)
+        {
+            n |= (size_t)(*p & 0x7F) << shift;
+            shift += 7;
+        }
+        return n;
+    }
+
+} //end namespace fsu
+
+#endif /* CGRAPH_H */
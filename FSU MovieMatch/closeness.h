@@ -0,0 +1,276 @@
+/*
+    closeness.h
+    Andrew J Wood
+    COP 4530
+
+    Top-k closeness centrality: the k vertices with the smallest total
+    distance (farness) to the rest of their component.
+
+    Distances are counted in units of stride edges, and only vertices at a
+    distance that is a multiple of stride are counted.  stride = 1 is the
+    classic definition; MovieMatch uses stride = 2 on its bipartite graph, so
+    that from an actor only actors are counted and farness is the sum of KB
+    numbers.
+
+    Ranking is done within the component of the largest-degree candidate
+    (the giant component in practice), where every source reaches the same
+    number of counted vertices, so the smallest farness is also the smallest
+    average distance.
+
+    The work:
+        -one BFS from the hub finds the component and the sources (candidate
+         vertices at a stride-aligned distance from the hub)
+        -sources are taken by decreasing degree, since hubs tend to be
+         central and give a good k-th best score early
+        -threads pull sources from a shared counter; each runs a level by
+         level BFS and, after every level, bounds the final farness below:
+         every vertex not yet counted is at least at the next counted
+         distance, and when that distance is the next level, at most
+         (sum of degrees - 1 over the current level) of them can be there;
+         the rest are one unit further.  The source is abandoned as soon as
+         the bound exceeds the k-th best farness found so far (the BFSCut
+         pruning of Bergamini et al.)
+        -each thread owns a queue and a stamp array of |V| entries, so memory
+         is threads * |V| * (2 * sizeof(Vertex)) beyond the graph
+
+    The result is exact, sorted by (farness, vertex), independent of the
+    thread count.
+
+    Note that the code is self-documenting.
+ */
+
+#ifndef CLOSENESS_H
+#define CLOSENESS_H
+
+#include <cstdlib>
+#include <cstdint>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <limits>
+#include <vector.h>
+#include <gheap.h>
+#include <vrtxorder.h>
+
+namespace fsu {
+
+    template < typename N >
+    struct Closeness
+    {
+        N       vertex_;
+        size_t  farness_;   //sum of distances, in stride units
+        size_t  reach_;     //counted vertices in the component, including vertex_
+
+        double  Average () const {return reach_ > 1 ? (double)farness_ / (reach_ - 1) : 0.0;}
+        bool    operator < (const Closeness & c) const
+        {
+            return farness_ < c.farness_ || (farness_ == c.farness_ && vertex_ < c.vertex_);
+        }
+    };
+
+    //shared state of one TopCloseness run
+    template < class G >
+    class ClosenessRun
+    {
+    public:
+
+        typedef typename G::Vertex              Vertex;
+        typedef typename G::AdjIterator         AdjIterator;
+        typedef fsu::Closeness<Vertex>          Score;
+
+        ClosenessRun (const G & g, const fsu::Vector<Vertex> & sources, size_t reach, size_t stride, size_t k)
+        :   g_(g), sources_(sources), reach_(reach), stride_(stride), k_(k),
+            next_(0), threshold_(std::numeric_limits<size_t>::max()), heap_(), mutex_()
+        {}
+
+        void    Work    (); //one thread's loop
+        void    Result  (fsu::Vector<Score> & top);
+
+    private:
+
+        bool    Farness (Vertex s, fsu::Vector<uint32_t> & stamp, uint32_t mark,
+                         fsu::Vector<Vertex> & queue, size_t & farness) const; //0 if cut
+        void    Offer   (Vertex s, size_t farness);
+
+        const G &                   g_;
+        const fsu::Vector<Vertex> & sources_;
+        size_t                      reach_;
+        size_t                      stride_;
+        size_t                      k_;
+        std::atomic<size_t>         next_;      //next source to hand out
+        std::atomic<size_t>         threshold_; //farness of the k-th best so far
+        fsu::Vector<Score>          heap_;      //max heap of the best k
+        std::mutex                  mutex_;
+    };
+
+    template < class G >
+    bool ClosenessRun<G>::Farness (Vertex s, fsu::Vector<uint32_t> & stamp, uint32_t mark,
+                                   fsu::Vector<Vertex> & queue, size_t & farness) const
+    {
+        size_t head = 0, tail = 0, counted = 1, level = 0;
+        farness = 0;
+        stamp[s] = mark;
+        queue[tail++] = s;
+        AdjIterator i;
+        while (head < tail)
+        {
+            //expand one level; fanout counts the edges leaving the new level, at
+            //most one of which per vertex leads back, so the level after it has
+            //at most fanout vertices
+            size_t levelEnd = tail, fanout = 0;
+            for (; head < levelEnd; ++head)
+            {
+                Vertex x = queue[head];
+                for (i = g_.Begin(x); i != g_.End(x); ++i)
+                {
+                    if (stamp[*i] != mark)
+                    {
+                        stamp[*i] = mark;
+                        queue[tail++] = *i;
+                        fanout += g_.OutDegree(*i) - 1;
+                    }
+                }
+            }
+            ++level;
+            if (level % stride_ == 0)
+            {
+                farness += (tail - levelEnd) * (level / stride_);
+                counted += tail - levelEnd;
+            }
+            //uncounted vertices sit at the next counted distance or beyond, and
+            //if that is the very next level, no more than fanout of them fit there
+            size_t rest = reach_ - counted;
+            size_t next = level / stride_ + 1;
+            size_t near = ((level + 1) % stride_ == 0 && fanout < rest) ? fanout : rest;
+            size_t bound = farness + near * next + (rest - near) * (next + 1);
+            if (bound > threshold_.load(std::memory_order_relaxed))
+                return 0;
+        }
+        return 1;
+    }
+
+    template < class G >
+    void ClosenessRun<G>::Offer (Vertex s, size_t farness)
+    {
+        Score c;
+        c.vertex_ = s;
+        c.farness_ = farness;
+        c.reach_ = reach_;
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (heap_.Size() < k_)
+        {
+            heap_.PushBack(c);
+            fsu::g_push_heap(heap_.Begin(), heap_.End());
+        }
+        else if (c < heap_[0])
+        {
+            fsu::g_pop_heap(heap_.Begin(), heap_.End());
+            heap_.Back() = c;
+            fsu::g_push_heap(heap_.Begin(), heap_.End());
+        }
+        if (heap_.Size() == k_)
+            threshold_.store(heap_[0].farness_);
+    }
+
+    template < class G >
+    void ClosenessRun<G>::Work ()
+    {
+        fsu::Vector<uint32_t> stamp(g_.VrtxSize(), 0);
+        fsu::Vector<Vertex> queue(g_.VrtxSize());
+        uint32_t mark = 0;
+        size_t farness;
+        for (size_t j = next_++; j < sources_.Size(); j = next_++)
+        {
+            if (++mark == 0) //stamps wrapped; start over
+            {
+                for (size_t x = 0; x < stamp.Size(); ++x)
+                    stamp[x] = 0;
+                mark = 1;
+            }
+            if (Farness(sources_[j], stamp, mark, queue, farness))
+                Offer(sources_[j], farness);
+        }
+    }
+
+    template < class G >
+    void ClosenessRun<G>::Result (fsu::Vector<Score> & top)
+    {
+        top = heap_;
+        fsu::g_heap_sort(top.Begin(), top.End());
+    }
+
+    //candidate(v) selects the vertices that may be ranked; threads = 0 uses every core
+    template < class G, class P >
+    void TopCloseness (const G & g, size_t k, P & candidate, fsu::Vector< Closeness<typename G::Vertex> > & top,
+                       size_t stride = 1, size_t threads = 0)
+    {
+        typedef typename G::Vertex Vertex;
+        top.Clear();
+        size_t n = g.VrtxSize();
+        if (n == 0 || k == 0)
+            return;
+        if (stride == 0)
+            stride = 1;
+
+        //hub = largest-degree candidate
+        fsu::Vector<Vertex> byDegree;
+        SortByDegree(g, byDegree, 1);
+        size_t h = 0;
+        while (h < n && !candidate(byDegree[h]))
+            ++h;
+        if (h == n)
+            return;
+        Vertex hub = byDegree[h];
+
+        //distances from the hub mark the component and the stride-aligned vertices
+        fsu::Vector<size_t> distance(n, n);
+        fsu::Vector<Vertex> queue;
+        queue.SetCapacity(n);
+        typename G::AdjIterator i;
+        distance[hub] = 0;
+        queue.PushBack(hub);
+        for (size_t head = 0; head < queue.Size(); ++head)
+        {
+            Vertex x = queue[head];
+            for (i = g.Begin(x); i != g.End(x); ++i)
+            {
+                if (distance[*i] == n)
+                {
+                    distance[*i] = distance[x] + 1;
+                    queue.PushBack(*i);
+                }
+            }
+        }
+        size_t reach = 0;
+        fsu::Vector<Vertex> sources;
+        for (size_t r = 0; r < n; ++r)
+        {
+            Vertex v = byDegree[r];
+            if (distance[v] < n && distance[v] % stride == 0)
+            {
+                ++reach;
+                if (candidate(v))
+                    sources.PushBack(v);
+            }
+        }
+
+        if (threads == 0)
+            threads = std::thread::hardware_concurrency();
+        if (threads == 0)
+            threads = 1;
+        ClosenessRun<G> run(g, sources, reach, stride, k);
+        fsu::Vector<std::thread*> pool;
+        for (size_t t = 1; t < threads; ++t)
+            pool.PushBack(new std::thread(&ClosenessRun<G>::Work, &run));
+        run.Work();
+        for (size_t t = 0; t < pool.Size(); ++t)
+        {
+            pool[t]->join();
+            delete pool[t];
+        }
+        run.Result(top);
+    }
+
+} //end namespace fsu
+
+#endif /* CLOSENESS_H */
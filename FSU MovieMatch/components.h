@@ -0,0 +1,241 @@
+/*
+    components.h
+    Andrew J Wood
+    COP 4530
+
+    Defines and implements Components, the connected components of an
+    undirected graph, found once by a parallel union-find pass and then
+    answered in O(1):
+
+        Component(v)    dense component id of v, 0 .. Count() - 1; ids are
+                        assigned by decreasing size (ties by smallest vertex),
+                        so component 0 is the largest
+        Size(c)         number of vertices in component c
+        Same(v, w)      1 iff v and w are connected
+
+    The union-find is lock free.  The vertex range is split among threads;
+    each thread unions every edge (v, w) with v < w of its vertices.  Links
+    always go from the larger root id to the smaller one by compare-and-swap,
+    and Find halves paths as it climbs, so concurrent unions never form a
+    cycle and every thread eventually sees a common root.
+
+    Note that the code is self-documenting.
+ */
+
+#ifndef COMPONENTS_H
+#define COMPONENTS_H
+
+#include <iostream>
+#include <cstdlib>
+#include <atomic>
+#include <thread>
+#include <vector.h>
+#include <gheap.h>
+
+namespace fsu {
+
+    template < typename N >
+    class Components
+    {
+    public:
+
+        typedef N   Vertex;
+
+        template < class G >
+        void    Build       (const G & g, size_t threads = 0); //threads = 0 uses every core
+
+        size_t  VrtxSize    () const {return comp_.Size();}
+        size_t  Count       () const {return size_.Size();}
+        size_t  Component   (Vertex v) const {return comp_[v];}
+        size_t  Size        (size_t c) const {return size_[c];}
+        size_t  SizeOf      (Vertex v) const {return size_[comp_[v]];}
+        bool    Same        (Vertex v, Vertex w) const {return comp_[v] == comp_[w];}
+
+        void    Distribution(std::ostream & os) const; //component counts by size, in powers of two
+        void    Clear       ();
+
+                Components  () : comp_(), size_() {}
+
+    private:
+
+        static Vertex Find  (std::atomic<Vertex> * parent, Vertex x);
+        static void Union   (std::atomic<Vertex> * parent, Vertex x, Vertex y);
+        template < class G >
+        static void Work    (const G & g, std::atomic<Vertex> * parent, size_t begin, size_t end);
+
+        //orders components by decreasing size, then by first vertex
+        class BySize
+        {
+        public:
+            BySize (const fsu::Vector<size_t> & size, const fsu::Vector<Vertex> & first) : size_(size), first_(first) {}
+            bool operator () (size_t a, size_t b) const
+            {
+                return size_[a] > size_[b] || (size_[a] == size_[b] && first_[a] < first_[b]);
+            }
+        private:
+            const fsu::Vector<size_t> & size_;
+            const fsu::Vector<Vertex> & first_;
+        };
+
+        fsu::Vector<Vertex>     comp_;  //comp_[v] = component id of v
+        fsu::Vector<size_t>     size_;  //size_[c] = vertices in component c
+
+    }; //end class Components
+
+
+    //----
+    //Components implementations
+    //----
+
+    template < typename N >
+    typename Components<N>::Vertex Components<N>::Find (std::atomic<Vertex> * parent, Vertex x)
+    {
+        Vertex p = parent[x].load(std::memory_order_relaxed);
+        while (p != x)
+        {
+            Vertex gp = parent[p].load(std::memory_order_relaxed);
+            if (gp != p)
+                parent[x].compare_exchange_weak(p, gp, std::memory_order_relaxed); //path halving; losing the race is harmless
+            x = gp;
+            p = parent[x].load(std::memory_order_relaxed);
+        }
+        return x;
+    }
+
+    template < typename N >
+    void Components<N>::Union (std::atomic<Vertex> * parent, Vertex x, Vertex y)
+    {
+        for (;;)
+        {
+            x = Find(parent, x);
+            y = Find(parent, y);
+            if (x == y)
+                return;
+            if (x < y)
+                fsu::Swap(x, y);
+            Vertex expected = x; //x must still be a root
+            if (parent[x].compare_exchange_strong(expected, y))
+                return;
+        }
+    }
+
+    template < typename N >
+    template < class G >
+    void Components<N>::Work (const G & g, std::atomic<Vertex> * parent, size_t begin, size_t end)
+    {
+        typename G::AdjIterator i;
+        for (Vertex v = (Vertex)begin; v < end; ++v)
+        {
+            for (i = g.Begin(v); i != g.End(v); ++i)
+            {
+                if (v < *i)
+                    Union(parent, v, *i);
+            }
+        }
+    }
+
+    template < typename N >
+    template < class G >
+    void Components<N>::Build (const G & g, size_t threads)
+    {
+        size_t n = g.VrtxSize();
+        std::atomic<Vertex> * parent = new std::atomic<Vertex> [n];
+        for (size_t v = 0; v < n; ++v)
+            parent[v].store((Vertex)v, std::memory_order_relaxed);
+
+        if (threads == 0)
+            threads = std::thread::hardware_concurrency();
+        if (threads == 0)
+            threads = 1;
+        fsu::Vector<std::thread*> pool;
+        size_t chunk = (n + threads - 1) / threads;
+        for (size_t t = 1; t < threads && t * chunk < n; ++t)
+        {
+            size_t end = (t + 1) * chunk < n ? (t + 1) * chunk : n;
+            pool.PushBack(new std::thread(&Components<N>::Work<G>, std::cref(g), parent, t * chunk, end));
+        }
+        Work(g, parent, 0, chunk < n ? chunk : n);
+        for (size_t t = 0; t < pool.Size(); ++t)
+        {
+            pool[t]->join();
+            delete pool[t];
+        }
+
+        //roots become raw labels 0, 1, ... in order of smallest member
+        comp_.SetSize(n);
+        fsu::Vector<size_t> size;
+        fsu::Vector<Vertex> first;
+        for (Vertex v = 0; v < n; ++v)
+        {
+            Vertex r = Find(parent, v);
+            if (r == v)
+            {
+                comp_[v] = (Vertex)size.Size();
+                size.PushBack(0);
+                first.PushBack(v);
+            }
+            else
+                comp_[v] = comp_[r]; //r < v, already labeled
+            ++size[comp_[v]];
+        }
+        delete [] parent;
+
+        //relabel by decreasing size
+        fsu::Vector<size_t> order(size.Size());
+        for (size_t c = 0; c < order.Size(); ++c)
+            order[c] = c;
+        BySize bySize(size, first);
+        fsu::g_heap_sort(order.Begin(), order.End(), bySize);
+        fsu::Vector<Vertex> rank(order.Size());
+        size_.SetSize(order.Size());
+        for (size_t k = 0; k < order.Size(); ++k)
+        {
+            rank[order[k]] = (Vertex)k;
+            size_[k] = size[order[k]];
+        }
+        for (Vertex v = 0; v < n; ++v)
+            comp_[v] = rank[comp_[v]];
+    }
+
+    template < typename N >
+    void Components<N>::Distribution (std::ostream & os) const
+    {
+        os << " " << Count() << " components";
+        if (Count() > 0)
+            os << ", largest " << size_[0] << " of " << VrtxSize() << " vertices";
+        os << "\n    size         components\n";
+        size_t lo = 1;
+        size_t k = Count();
+        while (k > 0)
+        {
+            //components are sorted by decreasing size, so each bucket is a run from the back
+            size_t count = 0;
+            while (k > 0 && size_[k-1] < 2 * lo)
+            {
+                ++count;
+                --k;
+            }
+            if (count > 0)
+            {
+                os << "    ";
+                os.width(6);
+                os << lo << " - ";
+                os.width(6);
+                os << 2 * lo - 1 << "  ";
+                os.width(8);
+                os << count << '\n';
+            }
+            lo *= 2;
+        }
+    }
+
+    template < typename N >
+    void Components<N>::Clear ()
+    {
+        comp_.Clear();
+        size_.Clear();
+    }
+
+} //end namespace fsu
+
+#endif /* COMPONENTS_H */
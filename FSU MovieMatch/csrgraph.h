@@ -0,0 +1,408 @@
+/*
+    csrgraph.h
+    Andrew J Wood
+    COP 4530
+
+    Defines and implements CSRGraph, a read-only undirected graph whose
+    adjacency lists are stored back to back in one array (compressed sparse
+    row form) and kept sorted by vertex id.
+
+    Layout:
+
+        adj_[offset_[x]] ... adj_[offset_[x+1] - 1]   neighbors of x, ascending
+
+    Because every list is sorted:
+        -HasEdge is a binary search, O(log d) instead of O(d)
+        -the neighbors common to two vertices are found by a merge of two
+         sorted arrays (Intersect, CommonSize) instead of a nested scan
+
+    Intersect picks a kernel by the shape of the input:
+        -very different list lengths: galloping search through the longer
+         list (g_set_intersection_gallop), O(d1 log(d2/d1))
+        -similar lengths, 32-bit ids, SSE2 available: 4 x 4 block compare,
+         every element of one block against every rotation of the other
+        -otherwise: a scalar merge (IntersectSorted)
+
+    Shuffle permutes each list in place for randomized path selection; the
+    lists are then unsorted until Sort() is called, and the sorted-only
+    operations fall back to linear scans.
+
+    Sort runs on every core: the vertices are cut into runs holding about
+    the same number of edges, and the runs are sorted as parallel tasks.
+
+    AdjIterator is a plain pointer, so BFSurvey and DFSurvey run on a
+    CSRGraph unchanged.
+
+    Note that the code is self-documenting.
+ */
+
+#ifndef CSRGRAPH_H
+#define CSRGRAPH_H
+
+#include <iostream>
+#include <cstdlib>
+#include <cstdint>
+#include <vector.h>
+#include <gheap.h>
+#include <gsort.h>
+#include <gpsort.h>
+#include <gset.h>
+#include <gbsearch.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace fsu {
+
+    //lists whose lengths differ by more than this factor are intersected by galloping
+    const size_t csrGallopRatio = 32;
+
+    //counts (and optionally writes) the common elements of two sorted arrays
+    template < typename T >
+    size_t IntersectSorted (const T * a, size_t na, const T * b, size_t nb, T * out)
+    {
+        size_t i = 0, j = 0, count = 0;
+        while (i < na && j < nb)
+        {
+            if (a[i] < b[j])
+                ++i;
+            else if (b[j] < a[i])
+                ++j;
+            else
+            {
+                if (out) out[count] = a[i];
+                ++count;
+                ++i;
+                ++j;
+            }
+        }
+        return count;
+    }
+
+    //32-bit ids: SIMD block kernel, then the scalar merge for the tails
+    inline size_t IntersectSorted (const uint32_t * a, size_t na, const uint32_t * b, size_t nb, uint32_t * out)
+    {
+        size_t i = 0, j = 0, count = 0;
+#if defined(__SSE2__)
+        //compare a block of 4 from a with all 4 rotations of a block of 4 from b;
+        //advance whichever block ends with the smaller value
+        while (i + 4 <= na && j + 4 <= nb)
+        {
+            __m128i va = _mm_loadu_si128((const __m128i *)(a + i));
+            __m128i vb = _mm_loadu_si128((const __m128i *)(b + j));
+            __m128i eq = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi32(va, vb),
+                             _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(0,3,2,1)))),
+                _mm_or_si128(_mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(1,0,3,2))),
+                             _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(2,1,0,3)))));
+            int mask = _mm_movemask_ps(_mm_castsi128_ps(eq)); //bit k set: a[i+k] occurs in the b block
+            for (int k = 0; k < 4; ++k)
+            {
+                if (mask & (1 << k))
+                {
+                    if (out) out[count] = a[i+k];
+                    ++count;
+                }
+            }
+            uint32_t amax = a[i+3], bmax = b[j+3];
+            if (amax <= bmax) i += 4;
+            if (bmax <= amax) j += 4;
+        }
+#endif
+        size_t tail = IntersectSorted<uint32_t>(a + i, na - i, b + j, nb - j, out ? out + count : out);
+        return count + tail;
+    }
+
+    template < typename N >
+    class CSRGraph
+    {
+    public:
+
+        typedef N           Vertex;
+        typedef const N *   AdjIterator;
+
+        template < class G >
+        void    Build       (const G & g);  //freezes any graph with the survey interface
+
+        size_t  VrtxSize    () const {return offset_.Size() - 1;}
+        size_t  EdgeSize    () const {return edgeSize_;}
+        size_t  OutDegree   (Vertex v) const {return offset_[v+1] - offset_[v];}
+        size_t  InDegree    (Vertex v) const {return OutDegree(v);}
+        bool    HasEdge     (Vertex from, Vertex to) const;
+
+        //neighbors shared by a and b, ascending; CommonSize only counts them
+        void    Intersect   (Vertex a, Vertex b, fsu::Vector<Vertex> & common) const;
+        size_t  Intersect   (Vertex a, Vertex b, Vertex * out) const; //out has room for the smaller degree; 0: count only
+        size_t  CommonSize  (Vertex a, Vertex b) const;
+
+        void    Clear       ();
+        void    Dump        (std::ostream & os) const;
+        void    Shuffle     ();     //randomizes list order; lists are unsorted afterwards
+        void    Sort        ();     //restores ascending list order
+        bool    Sorted      () const {return sorted_;}
+        void    Relabel     (const fsu::Vector<Vertex> & perm); //vertex v becomes perm[v]
+        size_t  ByteSize    () const {return adj_.Size() * sizeof(Vertex) + offset_.Size() * sizeof(size_t);}
+
+        AdjIterator Begin   (Vertex x) const {return adj_.Begin() + offset_[x];}
+        AdjIterator End     (Vertex x) const {return adj_.Begin() + offset_[x+1];}
+
+        CSRGraph            ();
+        template < class G >
+        explicit CSRGraph   (const G & g);
+
+    private:
+
+        void    SortList    (Vertex x);
+
+        //sorts the lists of the vertices first_[c] .. first_[c+1] - 1, task c
+        class SortLists
+        {
+        public:
+            SortLists (CSRGraph & g, const fsu::Vector<size_t> & first) : g_(g), first_(first) {}
+            void operator () (size_t c)
+            {
+                for (size_t x = first_[c]; x < first_[c+1]; ++x)
+                    g_.SortList((Vertex)x);
+            }
+        private:
+            CSRGraph &                  g_;
+            const fsu::Vector<size_t> & first_;
+        };
+        size_t  Random      (size_t range); //xorshift; Shuffle is repeatable from a fresh graph
+
+        fsu::Vector<Vertex>     adj_;       //all lists back to back
+        fsu::Vector<size_t>     offset_;    //offset_[x] = start of x's list; offset_[VrtxSize()] = end
+        size_t                  edgeSize_;
+        bool                    sorted_;
+        uint64_t                seed_;
+
+    }; //end class CSRGraph
+
+
+    //----
+    //CSRGraph implementations
+    //----
+
+    template < typename N >
+    CSRGraph<N>::CSRGraph () : adj_(), offset_(1, 0), edgeSize_(0), sorted_(1), seed_(88172645463325252ull)
+    {}
+
+    template < typename N >
+    template < class G >
+    CSRGraph<N>::CSRGraph (const G & g) : adj_(), offset_(1, 0), edgeSize_(0), sorted_(1), seed_(88172645463325252ull)
+    {
+        Build(g);
+    }
+
+    template < typename N >
+    template < class G >
+    void CSRGraph<N>::Build (const G & g)
+    {
+        size_t n = g.VrtxSize();
+        offset_.SetSize(n + 1);
+        size_t total = 0;
+        for (Vertex x = 0; x < n; ++x)
+        {
+            offset_[x] = total;
+            total += g.OutDegree(x);
+        }
+        offset_[n] = total;
+
+        adj_.SetSize(total);
+        typename G::AdjIterator i;
+        for (Vertex x = 0; x < n; ++x)
+        {
+            Vertex * p = adj_.Begin() + offset_[x];
+            for (i = g.Begin(x); i != g.End(x); ++i)
+                *p++ = *i;
+        }
+        edgeSize_ = total / 2;
+        sorted_ = 0;
+        Sort();
+    }
+
+    template < typename N >
+    void CSRGraph<N>::SortList (Vertex x)
+    {
+        Vertex * beg = adj_.Begin() + offset_[x];
+        Vertex * end = adj_.Begin() + offset_[x+1];
+        if (end - beg < 2) return;
+        //most lists are short; insertion sort beats heap sort there
+        if (end - beg <= 16)
+        {
+            for (Vertex * k = beg + 1; k != end; ++k)
+            {
+                Vertex t = *k;
+                Vertex * m = k;
+                for (; m != beg && t < *(m-1); --m)
+                    *m = *(m-1);
+                *m = t;
+            }
+        }
+        else
+            fsu::g_sort(beg, end);
+    }
+
+    template < typename N >
+    void CSRGraph<N>::Sort ()
+    {
+        if (sorted_) return;
+        //runs of about equal edge count; many more runs than cores, so a hub's long list does not hold up the rest
+        const size_t runs = 256;
+        size_t n = VrtxSize();
+        fsu::Vector<size_t> first(runs + 1);
+        for (size_t c = 0; c < runs; ++c)
+            first[c] = fsu::g_lower_bound(offset_.Begin(), offset_.Begin() + n, adj_.Size() * c / runs) - offset_.Begin();
+        first[runs] = n;
+        SortLists sortLists(*this, first);
+        fsu::g_parallel_for(runs, sortLists);
+        sorted_ = 1;
+    }
+
+    template < typename N >
+    bool CSRGraph<N>::HasEdge (Vertex from, Vertex to) const
+    {
+        if (sorted_)
+            return fsu::g_binary_search(Begin(from), End(from), to);
+        for (AdjIterator i = Begin(from); i != End(from); ++i)
+        {
+            if (*i == to) return 1;
+        }
+        return 0;
+    }
+
+    template < typename N >
+    size_t CSRGraph<N>::Intersect (Vertex a, Vertex b, Vertex * out) const
+    {
+        AdjIterator ab = Begin(a), ae = End(a), bb = Begin(b), be = End(b);
+        fsu::Vector<Vertex> sa, sb; //sorted copies, used only after Shuffle
+        if (!sorted_)
+        {
+            sa.SetSize(ae - ab);
+            sb.SetSize(be - bb);
+            fsu::g_copy(ab, ae, sa.Begin());
+            fsu::g_copy(bb, be, sb.Begin());
+            fsu::g_heap_sort(sa.Begin(), sa.End());
+            fsu::g_heap_sort(sb.Begin(), sb.End());
+            ab = sa.Begin(); ae = sa.End();
+            bb = sb.Begin(); be = sb.End();
+        }
+        size_t na = ae - ab, nb = be - bb;
+        if (na > nb)
+        {
+            fsu::Swap(ab, bb); fsu::Swap(ae, be); fsu::Swap(na, nb);
+        }
+        if (na == 0) return 0;
+
+        if (nb / na > csrGallopRatio)
+        {
+            //a is the short list: one galloping probe per element
+            fsu::Vector<Vertex> tmp;
+            if (!out)
+            {
+                tmp.SetSize(na);
+                out = tmp.Begin();
+            }
+            return fsu::g_set_intersection_gallop(ab, ae, bb, be, out) - out;
+        }
+        return IntersectSorted(ab, na, bb, nb, out);
+    }
+
+    template < typename N >
+    void CSRGraph<N>::Intersect (Vertex a, Vertex b, fsu::Vector<Vertex> & common) const
+    {
+        size_t na = OutDegree(a), nb = OutDegree(b);
+        common.SetSize(na < nb ? na : nb);
+        common.SetSize(Intersect(a, b, common.Begin()));
+    }
+
+    template < typename N >
+    size_t CSRGraph<N>::CommonSize (Vertex a, Vertex b) const
+    {
+        return Intersect(a, b, (Vertex *)0);
+    }
+
+    template < typename N >
+    void CSRGraph<N>::Clear ()
+    {
+        adj_.Clear();
+        offset_.SetSize(1);
+        offset_[0] = 0;
+        edgeSize_ = 0;
+        sorted_ = 1;
+    }
+
+    template < typename N >
+    void CSRGraph<N>::Dump (std::ostream & os) const
+    {
+        AdjIterator j;
+        for (Vertex v = 0; v < VrtxSize(); ++v)
+        {
+            os << "[" << v << "]->";
+            j = Begin(v);
+            if (j != End(v))
+            {
+                os << *j;
+                ++j;
+            }
+            for (; j != End(v); ++j)
+            {
+                os << ',' << *j;
+            }
+            os << '\n';
+        }
+    }
+
+    template < typename N >
+    size_t CSRGraph<N>::Random (size_t range)
+    {
+        seed_ ^= seed_ << 13;
+        seed_ ^= seed_ >> 7;
+        seed_ ^= seed_ << 17;
+        return (size_t)(seed_ % range);
+    }
+
+    template < typename N >
+    void CSRGraph<N>::Shuffle ()
+    {
+        //Fisher-Yates on each list
+        for (Vertex x = 0; x < VrtxSize(); ++x)
+        {
+            Vertex * beg = adj_.Begin() + offset_[x];
+            size_t d = OutDegree(x);
+            for (size_t k = d; k > 1; --k)
+                fsu::Swap(beg[k-1], beg[Random(k)]);
+        }
+        sorted_ = 0;
+    }
+
+    template < typename N >
+    void CSRGraph<N>::Relabel (const fsu::Vector<Vertex> & perm)
+    {
+        //perm must be a permutation of [0,VrtxSize)
+        size_t n = VrtxSize();
+        fsu::Vector<size_t> offset(n + 1);
+        offset[0] = 0;
+        fsu::Vector<Vertex> inv(n);
+        for (Vertex v = 0; v < n; ++v)
+            inv[perm[v]] = v;
+        for (Vertex w = 0; w < n; ++w)
+            offset[w+1] = offset[w] + OutDegree(inv[w]);
+
+        fsu::Vector<Vertex> adj(adj_.Size());
+        for (Vertex w = 0; w < n; ++w)
+        {
+            Vertex * p = adj.Begin() + offset[w];
+            for (AdjIterator i = Begin(inv[w]); i != End(inv[w]); ++i)
+                *p++ = perm[*i];
+        }
+        adj_.Swap(adj);
+        offset_.Swap(offset);
+        sorted_ = 0;
+        Sort();
+    }
+
+} //end namespace fsu
+
+#endif /* CSRGRAPH_H */
@@ -6,6 +6,12 @@
  This is the header file for the depth-first survey.  It defines and implements the
  DFSurvery class which is used to do a depth-first search of a given graph.
  
+ The per-vertex arrays are stored in the graph's Vertex type; since discovery
+ and finishing times run up to 2|V|, the Vertex type must be able to hold 2|V|.
+ 
+ The control stack is an array of |V| vertices with a top index.  Search(v)
+ starts it empty and pushes each vertex at most once, so it never grows.
+ 
  Note that the code is self-documenting.
  */
 
@@ -13,7 +19,6 @@
 #define DFSURVEY_H
 
 #include <vector.h>
-#include <deque.h>
 
 namespace fsu {
 
@@ -49,7 +54,8 @@ namespace fsu {
         fsu::Vector<Vertex>                 parent_; //for DFS tree
         fsu::Vector<char>                   color_;
         fsu::Vector<AdjIterator>            neighbor_; //vector of list iterators (points to neighbor)
-        fsu::Deque<Vertex>                  conQ_; //the control stack
+        fsu::Vector<Vertex>                 conQ_; //the control stack, |V| slots
+        size_t                              top_;  //one past top of stack
         
     public:
         
@@ -79,12 +85,13 @@ namespace fsu {
     template < class G >
     DFSurvey<G>::DFSurvey (const Graph & g)
     :   g_(g), start_(0), time_(0), forever_(2*g_.VrtxSize()), null_((Vertex)g_.VrtxSize()),
-        dtime_      (g_.VrtxSize(), forever_),
-        ftime_      (g_.VrtxSize(), forever_),
+        dtime_      (g_.VrtxSize(), (Vertex)forever_),
+        ftime_      (g_.VrtxSize(), (Vertex)forever_),
         parent_     (g_.VrtxSize(), null_),
         color_      (g_.VrtxSize(), 'w'),
         neighbor_   (g_.VrtxSize()),
-        conQ_()
+        conQ_       (g_.VrtxSize()), top_(0),
+        traceQue    (0)
     {
         for (Vertex x = 0; x < g_.VrtxSize(); ++x)
             neighbor_[x] = g_.Begin(x);
@@ -93,12 +100,13 @@ namespace fsu {
     template < class G >
     DFSurvey<G>::DFSurvey (const Graph & g, Vertex start)
     :   g_(g), start_(start), time_(0), forever_(2*g_.VrtxSize()), null_((Vertex)g_.VrtxSize()),
-    dtime_      (g_.VrtxSize(), forever_),
-    ftime_      (g_.VrtxSize(), forever_),
+    dtime_      (g_.VrtxSize(), (Vertex)forever_),
+    ftime_      (g_.VrtxSize(), (Vertex)forever_),
     parent_     (g_.VrtxSize(), null_),
     color_      (g_.VrtxSize(), 'w'),
     neighbor_   (g_.VrtxSize()),
-    conQ_()
+    conQ_       (g_.VrtxSize()), top_(0),
+    traceQue    (0)
     {
         for (Vertex x = 0; x < g_.VrtxSize(); ++x)
             neighbor_[x] = g_.Begin(x);
@@ -128,21 +136,23 @@ namespace fsu {
     template < class G >
     void DFSurvey<G>::Search(Vertex v)
     {
+        Vertex * stack = conQ_.Begin(); //each vertex is pushed once, so |V| slots suffice
+        top_ = 0;
         dtime_[v] = time_++;
-        conQ_.PushBack(v);
+        stack[top_++] = v;
         if (traceQue)
             ShowQue(std::cout);
         color_[v] = 'g';
         Vertex top;
         AdjIterator i;
-        while (!conQ_.Empty())
+        while (top_ > 0)
         {
-            top = conQ_.Back();
+            top = stack[top_ - 1];
             i = NextNeighbor(top);
             if (i != g_.End(top))
             {
                 dtime_[*i] = time_++;
-                conQ_.PushBack(*i);
+                stack[top_++] = *i;
                 if (traceQue)
                     ShowQue(std::cout);
                 parent_[*i] = top;
@@ -150,7 +160,7 @@ namespace fsu {
             }
             else
             {
-                conQ_.PopBack();
+                --top_;
                 if (traceQue)
                     ShowQue(std::cout);
                 color_[top] = 'b';
@@ -163,13 +173,14 @@ namespace fsu {
     void DFSurvey<G>::Reset()
     {
         time_ = 0;
-        conQ_.Clear();
+        top_ = 0;
         if (color_.Size() != g_.VrtxSize()) //changed vertex size
         {
+            conQ_.SetSize(g_.VrtxSize());
             forever_    = 2*g_.VrtxSize();
             null_       = (Vertex)g_.VrtxSize();
-            dtime_.SetSize (g_.VrtxSize(), forever_);
-            ftime_.SetSize (g_.VrtxSize(), forever_);
+            dtime_.SetSize (g_.VrtxSize(), (Vertex)forever_);
+            ftime_.SetSize (g_.VrtxSize(), (Vertex)forever_);
             parent_.SetSize (g_.VrtxSize(), null_);
             color_.SetSize (g_.VrtxSize(), 'w');
             neighbor_.SetSize(g_.VrtxSize());
@@ -180,8 +191,8 @@ namespace fsu {
         {
             for (Vertex x = 0; x < g_.VrtxSize(); ++x)
             {
-                dtime_[x] = forever_;
-                ftime_[x] = forever_;
+                dtime_[x] = (Vertex)forever_;
+                ftime_[x] = (Vertex)forever_;
                 parent_[x] = null_;
                 color_[x] = 'w';
                 neighbor_[x] = g_.Begin(x);
@@ -211,10 +222,11 @@ namespace fsu {
     void DFSurvey<G>::ShowQue (std::ostream& os) const
     {
         os << "  ";
-        if (conQ_.Empty())
+        if (top_ == 0)
             os << "NULL";
         else
-            conQ_.Display(os, ' ');
+            for (size_t k = 0; k < top_; ++k)
+                os << conQ_[k] << ' ';
         os << '\n';
     }
 
@@ -0,0 +1,208 @@
+/*
+    ecc.h
+    Andrew J Wood
+    COP 4530
+
+    Defines and implements Eccentricity, which computes the exact diameter of
+    a component and per-vertex eccentricity bounds with a few breadth-first
+    surveys instead of one per vertex.
+
+    Only target vertices count as path ends: the eccentricity of x is the
+    largest distance from x to a target in its component, and the diameter is
+    the largest over the target vertices.  With every vertex a target these
+    are the usual definitions; MovieMatch uses the actors, so the diameter is
+    twice the largest finite KB number.
+
+    Each survey from a vertex u (Sweep) tightens the bounds of every vertex v
+    in u's component (Takes and Kosters):
+
+        max(d(u,v), ecc(u) - d(u,v))  <=  ecc(v)  <=  ecc(u) + d(u,v)
+
+    (the d(u,v) term only when u is itself a target).
+
+    Diameter runs iFUB (Crescenzi et al.):
+        -a double sweep from the start gives a lower bound lb and a path
+         between two far apart targets; the middle vertex r of that path
+         is the root
+        -targets are visited by decreasing distance i from r; every pair of
+         targets both within distance i - 1 of r is at most 2(i - 1) apart,
+         so once lb >= 2(i - 1) after finishing level i, lb is the diameter
+    On small-world graphs this stops after a handful of levels.
+
+    P is a predicate class: bool operator () (Vertex) selects the targets.
+
+    Note that the code is self-documenting.
+ */
+
+#ifndef ECC_H
+#define ECC_H
+
+#include <cstdlib>
+#include <vector.h>
+#include <bfsurvey.h>
+
+namespace fsu {
+
+    template < class G, class P >
+    class Eccentricity
+    {
+    public:
+
+        typedef G                           Graph;
+        typedef typename Graph::Vertex      Vertex;
+        typedef fsu::BFSurvey<Graph>        Survey;
+
+                Eccentricity    (const Graph & g, P & target);
+
+        size_t  Sweep           (Vertex u); //surveys from u; returns ecc(u) and updates the bounds
+        size_t  DoubleSweep     (Vertex start, Vertex & a, Vertex & b); //lower bound d(a,b) on the diameter
+        size_t  Diameter        (Vertex start, Vertex & a, Vertex & b); //exact diameter of start's component, d(a,b)
+
+        size_t  Lower           (Vertex v) const {return lower_[v];}
+        size_t  Upper           (Vertex v) const {return upper_[v];} //InfiniteDistance() until v's component is surveyed
+        size_t  Sweeps          () const {return sweeps_;}
+        size_t  InfiniteDistance() const {return bfs_.InfiniteDistance();}
+
+    private:
+
+        Eccentricity            (const Eccentricity &); //bfs_ refers to g_
+        Eccentricity & operator=(const Eccentricity &);
+
+        Vertex  Farthest        () const; //target farthest from the last survey's origin (smallest id on ties)
+        bool    Reached         (Vertex v) const {return bfs_.Distance()[v] < (Vertex)bfs_.InfiniteDistance();}
+
+        const Graph &           g_;
+        P &                     target_;
+        Survey                  bfs_;
+        fsu::Vector<size_t>     lower_;
+        fsu::Vector<size_t>     upper_;
+        size_t                  sweeps_;
+
+    }; //end class Eccentricity
+
+
+    //----
+    //Eccentricity implementations
+    //----
+
+    template < class G, class P >
+    Eccentricity<G,P>::Eccentricity (const Graph & g, P & target)
+    :   g_(g), target_(target), bfs_(g), lower_(g.VrtxSize(), 0), upper_(g.VrtxSize(), 1 + g.EdgeSize()), sweeps_(0)
+    {
+        bfs_.traceQue = 0;
+    }
+
+    template < class G, class P >
+    typename Eccentricity<G,P>::Vertex Eccentricity<G,P>::Farthest () const
+    {
+        Vertex far = bfs_.NullVertex();
+        for (Vertex v = 0; v < g_.VrtxSize(); ++v)
+        {
+            if (Reached(v) && target_(v) && (far == bfs_.NullVertex() || bfs_.Distance()[v] > bfs_.Distance()[far]))
+                far = v;
+        }
+        return far;
+    }
+
+    template < class G, class P >
+    size_t Eccentricity<G,P>::Sweep (Vertex u)
+    {
+        ++sweeps_;
+        bfs_.Reset();
+        bfs_.Search(u);
+        Vertex far = Farthest();
+        size_t ecc = (far == bfs_.NullVertex()) ? 0 : bfs_.Distance()[far];
+        lower_[u] = upper_[u] = ecc;
+        for (Vertex v = 0; v < g_.VrtxSize(); ++v)
+        {
+            if (!Reached(v)) continue;
+            size_t d = bfs_.Distance()[v];
+            size_t lo = (ecc > d) ? ecc - d : 0;
+            if (target_(u) && d > lo) lo = d; //u is one of the targets v must reach
+            if (lo > lower_[v]) lower_[v] = lo;
+            if (ecc + d < upper_[v]) upper_[v] = ecc + d;
+        }
+        return ecc;
+    }
+
+    template < class G, class P >
+    size_t Eccentricity<G,P>::DoubleSweep (Vertex start, Vertex & a, Vertex & b)
+    {
+        Sweep(start);
+        a = Farthest();
+        if (a == bfs_.NullVertex())
+        {
+            a = b = start; //no targets in the component
+            return 0;
+        }
+        size_t lb = Sweep(a);
+        b = Farthest();
+        return lb;
+    }
+
+    template < class G, class P >
+    size_t Eccentricity<G,P>::Diameter (Vertex start, Vertex & a, Vertex & b)
+    {
+        size_t lb = DoubleSweep(start, a, b);
+        if (lb == 0)
+            return 0;
+
+        //root: the middle of the a-b path, read off the parent links of the survey from a
+        Vertex r = b;
+        for (size_t k = 0; k < lb / 2; ++k)
+            r = bfs_.Parent()[r];
+
+        //targets of r's component grouped by distance from r (counting sort)
+        Sweep(r);
+        size_t top = 0;
+        for (Vertex v = 0; v < g_.VrtxSize(); ++v)
+        {
+            if (Reached(v) && target_(v) && bfs_.Distance()[v] > top)
+                top = bfs_.Distance()[v];
+        }
+        if (target_(r) && top > lb)
+        {
+            lb = top; //a target at distance top from r
+            a = r;
+            b = Farthest();
+        }
+        fsu::Vector<size_t> level(top + 2, 0);
+        for (Vertex v = 0; v < g_.VrtxSize(); ++v)
+        {
+            if (Reached(v) && target_(v))
+                ++level[bfs_.Distance()[v] + 1];
+        }
+        for (size_t i = 1; i < level.Size(); ++i)
+            level[i] += level[i-1];
+        fsu::Vector<Vertex> fringe(level[top + 1]);
+        for (Vertex v = 0; v < g_.VrtxSize(); ++v)
+        {
+            if (Reached(v) && target_(v))
+                fringe[level[bfs_.Distance()[v]]++] = v;
+        }
+        //level[i] now marks the end of level i, level[i-1] its beginning
+
+        for (size_t i = top; i > 0; --i)
+        {
+            if (lb >= 2 * i)
+                break; //no pair within distance i of r can beat lb
+            for (size_t k = level[i-1]; k < level[i]; ++k)
+            {
+                Vertex x = fringe[k];
+                if (upper_[x] <= lb)
+                    continue; //bounds already rule x out
+                size_t ecc = Sweep(x);
+                if (ecc > lb)
+                {
+                    lb = ecc;
+                    a = x;
+                    b = Farthest();
+                }
+            }
+        }
+        return lb;
+    }
+
+} //end namespace fsu
+
+#endif /* ECC_H */
@@ -38,6 +38,7 @@ namespace fsu {
         void    Clear       ();
         void    Dump        (std::ostream & os);
         void    Shuffle     ();
+        void    Relabel     (const fsu::Vector<Vertex> & perm); //vertex v becomes perm[v]
         
         AdjIterator Begin   (Vertex x) const;
         AdjIterator End     (Vertex x) const;
@@ -162,6 +163,23 @@ namespace fsu {
             al_[v].Shuffle();
     }
     
+    template < typename N >
+    void ALUGraph<N>::Relabel(const fsu::Vector<Vertex> & perm)
+    {
+        //perm must be a permutation of [0,VrtxSize); list order is preserved
+        fsu::Vector <SetType> al(al_.Size());
+        for (Vertex v = 0; v < al_.Size(); ++v)
+        {
+            SetType & target = al[perm[v]];
+            while (!al_[v].Empty()) //pop as we go so the old lists are released while the new ones grow
+            {
+                target.PushBack(perm[al_[v].Front()]);
+                al_[v].PopFront();
+            }
+        }
+        al_.Swap(al);
+    }
+    
     template < typename N >
     typename ALUGraph<N>::AdjIterator ALUGraph<N>::Begin (Vertex x) const
     {
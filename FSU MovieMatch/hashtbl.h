@@ -8,6 +8,14 @@
     It is desgined to work with various hash functions (passed via template parameter as Hash function
     object classes) and can use various entry and bucket types.
  
+    The bucket count follows a BucketPolicy: as requested, the largest prime not above the request
+    (the default; found by Miller-Rabin, see primes.h, so sizing costs no sieve), or the next power
+    of two.  With a power of two, the hash value is run through a 64-bit mixer and masked instead of
+    reduced mod the bucket count, so weak low bits in the hash function do not cluster the buckets.
+ 
+    MaxBucketSize and Analysis measure how evenly a hash function spreads the actual keys:
+    Analysis prints the bucket size distribution next to the one uniform hashing would give.
+ 
     The code is desinged to be self-documenting.
 */
 
@@ -15,9 +23,10 @@
 #define _HASHTBL_H
 
 #include <cstdlib>
+#include <cstdint>
 #include <iostream>
 #include <iomanip>
-#include <cmath>    // used by Analysis in hashtbl.cpp
+#include <cmath>    // exp, used by Analysis
 
 #include <entry.h>
 #include <vector.h>
@@ -28,6 +37,8 @@
 namespace fsu
 {
 
+  enum BucketPolicy { anyBuckets = 0, primeBuckets = 1, powerOfTwoBuckets = 2 };
+
   template <typename K, typename D, class H>
   class HashTable;
 
@@ -79,8 +90,9 @@ namespace fsu
     ConstIterator  End           () const;
 
     // first ctor uses default hash object, second uses supplied hash object
-    explicit       HashTable     (size_t numBuckets = 100, bool prime = 1);
-    HashTable                    (size_t numBuckets, HashType hashObject, bool prime = 1);
+    // policy is a BucketPolicy; 0 and 1 keep their old meaning of "prime = false / true"
+    explicit       HashTable     (size_t numBuckets = 100, int policy = primeBuckets);
+    HashTable                    (size_t numBuckets, HashType hashObject, int policy = primeBuckets);
                    ~HashTable    ();
     HashTable                    (const HashTable<K,D,H>&);
     HashTable& operator =        (const HashTable&);
@@ -95,10 +107,16 @@ namespace fsu
     size_t                 numBuckets_;
     Vector < BucketType >  bucketVector_;
     HashType               hashObject_;
-    bool                   prime_;     // flag for prime number of buckets
+    int                    policy_;    // BucketPolicy for numBuckets_
 
     // private method calculates bucket index
     size_t  Index          (const KeyType& k) const;
+    static size_t BucketCount (size_t n, int policy);
+    static uint64_t Mix    (uint64_t h);
+
+    // bucket search comparing keys in place; no Entry is built for the probe
+    static typename BucketType::Iterator      Search (BucketType& b, const KeyType& k);
+    static typename BucketType::ConstIterator Search (const BucketType& b, const KeyType& k);
   } ;
 
   //--------------------------------------------
@@ -148,18 +166,18 @@ namespace fsu
   template <typename K, typename D, class H>
   HashTableIterator<K,D,H> HashTable<K,D,H>::Insert (const K& k, const D& d)
   {
-      EntryType e(k,d);
       Iterator i; //create Hash Table iterator
-      uint64_t hVal = hashObject_(k) % numBuckets_; //get bucket number for the key
+      uint64_t hVal = Index(k); //get bucket number for the key
       
-      typename BucketType::Iterator listIter = (bucketVector_[hVal]).Includes(e);  // check to see if key is already in bucket
+      typename BucketType::Iterator listIter = Search(bucketVector_[hVal], k);  // check to see if key is already in bucket
       if (listIter != bucketVector_[hVal].End()) //if the key was found in the bucket
       {
           (*listIter).data_ = d; //update data value of corresponding entry item
       }
       else //the key was not found
       {
-          bucketVector_[hVal].Insert(e); //insert the newly created entry object into the bucket
+          EntryType e(k,d);
+          listIter = bucketVector_[hVal].Insert(e); //insert the newly created entry object into the bucket
       }
     
       //set the values of the HashTableIterator
@@ -173,11 +191,9 @@ namespace fsu
   template <typename K, typename D, class H>
   bool HashTable<K,D,H>::Remove (const K& k)
   {
-      EntryType e(k);
-      Iterator i;
-      uint64_t hVal = hashObject_(k) % numBuckets_;
+      uint64_t hVal = Index(k);
       
-      typename BucketType::Iterator listIter = (bucketVector_[hVal].Includes(e));
+      typename BucketType::Iterator listIter = Search(bucketVector_[hVal], k);
       if (listIter != bucketVector_[hVal].End()) //if the key was found
       {
           bucketVector_[hVal].Remove(listIter); //remove item from corresponding list
@@ -190,11 +206,9 @@ namespace fsu
   template <typename K, typename D, class H>
   bool HashTable<K,D,H>::Retrieve (const K& k, D& d) const
   {
-      EntryType e(k);
-      Iterator i;
-      uint64_t hVal = hashObject_(k) % numBuckets_;
+      uint64_t hVal = Index(k);
       
-      typename BucketType::ConstIterator listIter = (bucketVector_[hVal].Includes(e));
+      typename BucketType::ConstIterator listIter = Search(bucketVector_[hVal], k);
       if (listIter != bucketVector_[hVal].End()) //if the key was found
       {
           d = (*listIter).data_; //set passed data value
@@ -207,11 +221,10 @@ namespace fsu
   template <typename K, typename D, class H>
   HashTableIterator<K,D,H> HashTable<K,D,H>::Includes (const K& k) const
   {
-      EntryType e(k);
       Iterator i; //create Hash Table iterator
-      uint64_t hVal = hashObject_(k) % numBuckets_; //get bucket number for the key
+      uint64_t hVal = Index(k); //get bucket number for the key
       
-      typename BucketType::ConstIterator listIter = (bucketVector_[hVal]).Includes(e);  // check to see if key is already in bucket
+      typename BucketType::ConstIterator listIter = Search(bucketVector_[hVal], k);  // check to see if key is already in bucket
       if (listIter != bucketVector_[hVal].End()) //if the key was found in the bucket
       {
           i.tablePtr_ = this;
@@ -228,11 +241,13 @@ namespace fsu
   template <typename K, typename D, class H>
   D& HashTable<K,D,H>::Get (const K& key)
   {
-    EntryType e(key);
     size_t bn = Index(key);
-    typename BucketType::Iterator i = bucketVector_[bn].Includes(e); 
+    typename BucketType::Iterator i = Search(bucketVector_[bn], key);
     if (i == bucketVector_[bn].End())
+    {
+      EntryType e(key);
       i = bucketVector_[bn].Insert(e);
+    }
     return (*i).data_;
   }
 
@@ -272,29 +287,17 @@ namespace fsu
   // constructors
 
   template <typename K, typename D, class H>
-  HashTable <K,D,H>::HashTable (size_t n, bool prime)
-    :  numBuckets_(n), bucketVector_(0), hashObject_(), prime_(prime)
+  HashTable <K,D,H>::HashTable (size_t n, int policy)
+    :  numBuckets_(BucketCount(n,policy)), bucketVector_(0), hashObject_(), policy_(policy)
   {
-    // ensure at least 2 buckets
-    if (numBuckets_ < 3)
-      numBuckets_ = 2;
-    // optionally convert to prime number of buckets
-    if (prime_)
-      numBuckets_ = fsu::PrimeBelow(numBuckets_);
     // create buckets
     bucketVector_.SetSize(numBuckets_);
   }
 
   template <typename K, typename D, class H>
-  HashTable <K,D,H>::HashTable (size_t n, H hashObject, bool prime)
-    :  numBuckets_(n), bucketVector_(0), hashObject_(hashObject), prime_(prime)
+  HashTable <K,D,H>::HashTable (size_t n, H hashObject, int policy)
+    :  numBuckets_(BucketCount(n,policy)), bucketVector_(0), hashObject_(hashObject), policy_(policy)
   {
-    // ensure at least 2 buckets
-    if (numBuckets_ < 3)
-      numBuckets_ = 2;
-    // optionally convert to prime number of buckets
-    if (prime_)
-      numBuckets_ = fsu::PrimeBelow(numBuckets_);
     // create buckets
     bucketVector_.SetSize(numBuckets_);
   }
@@ -303,7 +306,7 @@ namespace fsu
 
   template <typename K, typename D, class H>
   HashTable <K,D,H>::HashTable (const HashTable& ht)
-    :  numBuckets_(ht.numBuckets_), bucketVector_(ht.bucketVector_), hashObject_(ht.hashObject_)
+    :  numBuckets_(ht.numBuckets_), bucketVector_(ht.bucketVector_), hashObject_(ht.hashObject_), policy_(ht.policy_)
   {}
 
   template <typename K, typename D, class H>
@@ -314,6 +317,7 @@ namespace fsu
       numBuckets_ = ht.numBuckets_;
       bucketVector_ = ht.bucketVector_;
       hashObject_ = ht.hashObject_;
+      policy_ = ht.policy_;
     }
     return *this;
   }
@@ -330,7 +334,7 @@ namespace fsu
   void HashTable<K,D,H>::Rehash (size_t nb)
   {
     if (nb == 0) nb = Size();
-    HashTable<K,D,H> newTable(nb,hashObject_,prime_);
+    HashTable<K,D,H> newTable(nb,hashObject_,policy_);
     for (size_t i = 0; i < numBuckets_; ++i)
     {
       while (!bucketVector_[i].Empty()) // pop as we go saves local space bloat
@@ -417,9 +421,60 @@ namespace fsu
   template <typename K, typename D, class H>
   size_t HashTable <K,D,H>::Index (const K& k) const
   {
+    if (policy_ == powerOfTwoBuckets)
+      return (size_t)(Mix(hashObject_ (k)) & (numBuckets_ - 1));
     return hashObject_ (k) % numBuckets_;
   }
 
+  template <typename K, typename D, class H>
+  size_t HashTable <K,D,H>::BucketCount (size_t n, int policy)
+  {
+    // ensure at least 2 buckets
+    if (n < 3)
+      return 2;
+    if (policy == powerOfTwoBuckets)
+    {
+      size_t p = 2;
+      while (p < n && 2 * p > p)
+        p *= 2;
+      return p;
+    }
+    // optionally convert to prime number of buckets
+    if (policy == primeBuckets)
+      return fsu::PrimeBelow(n);
+    return n;
+  }
+
+  // the 64-bit finalizer of MurmurHash3: every input bit affects every output bit
+  template <typename K, typename D, class H>
+  uint64_t HashTable <K,D,H>::Mix (uint64_t h)
+  {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+  }
+
+  template <typename K, typename D, class H>
+  typename HashTable <K,D,H>::BucketType::Iterator HashTable <K,D,H>::Search (BucketType& b, const K& k)
+  {
+    typename BucketType::Iterator i = b.Begin();
+    while (i != b.End() && !((*i).key_ == k))
+      ++i;
+    return i;
+  }
+
+  template <typename K, typename D, class H>
+  typename HashTable <K,D,H>::BucketType::ConstIterator HashTable <K,D,H>::Search (const BucketType& b, const K& k)
+  {
+    typename BucketType::ConstIterator i = b.Begin();
+    while (i != b.End() && !((*i).key_ == k))
+      ++i;
+    return i;
+  }
+
   //--------------------------------------------
   //     HashTableIterator <K,D,H>
   //--------------------------------------------
@@ -547,20 +602,63 @@ namespace fsu
     return bucketItr_ != tablePtr_->bucketVector_[bucketNum_].End();
   }
 
-  // The stub implementations below should remain as-is.
-  // They will be implemented as a project in COP4531.
+  // analysis
 
   template <typename K, typename D, class H>
   size_t HashTable<K,D,H>::MaxBucketSize () const
-  {   
-    std::cout << " ** MaxBucketSize not implemented\n";
-    return 0;
+  {
+    size_t max = 0;
+    for (size_t i = 0; i < numBuckets_; ++i)
+      if (bucketVector_[i].Size() > max)
+        max = bucketVector_[i].Size();
+    return max;
   }
 
+  // Compares the bucket sizes with uniform hashing, under which the size of a bucket is
+  // Poisson with mean lambda = entries / buckets:
+  //   - the number of buckets of each size, actual and expected
+  //   - the mean number of entries examined by a successful search, 1 + lambda/2 expected
+  //   - chi-square of the bucket sizes, sum (size - lambda)^2 / lambda, about buckets - 1 expected
   template <typename K, typename D, class H>
   void HashTable<K,D,H>::Analysis (std::ostream& os) const
   {
-    os << " ** Analysis not implemented\n";
+    size_t max = MaxBucketSize();
+    Vector<size_t> count(max + 1, 0);
+    size_t entries = 0;
+    double probes = 0.0;
+    for (size_t i = 0; i < numBuckets_; ++i)
+    {
+      size_t s = bucketVector_[i].Size();
+      ++count[s];
+      entries += s;
+      probes += 0.5 * (double)s * (double)(s + 1);
+    }
+    double lambda = (double)entries / (double)numBuckets_;
+    double chi = 0.0;
+    for (size_t s = 0; s <= max; ++s)
+      chi += (double)count[s] * ((double)s - lambda) * ((double)s - lambda);
+    if (lambda > 0.0)
+      chi /= lambda;
+
+    std::ios_base::fmtflags flags = os.flags();
+    std::streamsize precision = os.precision();
+    os << std::fixed << std::setprecision(3);
+    os << " table size:          " << numBuckets_ << " buckets, " << entries << " entries\n"
+       << " load factor:         " << lambda << '\n'
+       << " max bucket size:     " << max << '\n'
+       << " mean search length:  " << (entries ? probes / (double)entries : 0.0)
+       << " (uniform: " << 1.0 + lambda / 2.0 << ")\n"
+       << " chi-square:          " << chi << " (uniform: about " << numBuckets_ - 1 << ")\n"
+       << " bucket size distribution:\n"
+       << std::setw(10) << "size" << std::setw(12) << "actual" << std::setw(14) << "uniform" << '\n';
+    double p = exp(-lambda); // Poisson probability of size s
+    for (size_t s = 0; s <= max; ++s)
+    {
+      os << std::setw(10) << s << std::setw(12) << count[s] << std::setw(14) << p * (double)numBuckets_ << '\n';
+      p *= lambda / (double)(s + 1);
+    }
+    os.flags(flags);
+    os.precision(precision);
   } // Analysis
 
 } // namespace fsu
@@ -0,0 +1,242 @@
+/*
+    hotswap.h
+    Andrew J Wood
+    COP 4530
+
+    Defines and implements the HotSwap<T> publication cell.
+
+    A HotSwap owns one current instance of T.  Readers pin the current instance
+    with a ReadGuard; a writer builds a replacement off to the side and calls
+    Publish(), which swaps the pointer atomically.  The old instance is retired,
+    not deleted: it is reclaimed only after every reader that could have seen it
+    has released its guard (epoch-based reclamation, RCU style).
+
+    Protocol:
+        -the cell keeps a global epoch, starting at 1
+        -a reader claims a slot by writing the epoch it observed into it,
+         and only then loads the current pointer
+        -Publish swaps the pointer, then advances the epoch to e; the old
+         instance is stamped with e
+        -a retired instance stamped e may be deleted once no slot holds an
+         epoch below e (slot value 0 means idle)
+
+    Readers never block writers and writers never block readers.  At most
+    maxReaders guards may be held at once; further readers spin until a slot
+    is released.
+
+    Note that the code is self-documenting.
+ */
+
+#ifndef HOTSWAP_H
+#define HOTSWAP_H
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <functional>
+#include <cstdlib>
+#include <vector.h>
+
+namespace fsu {
+
+    template < class T >
+    class HotSwap
+    {
+    public:
+
+        enum { maxReaders = 64 };
+
+        //pins the current instance for the lifetime of the guard
+        class ReadGuard
+        {
+        public:
+            explicit ReadGuard      (const HotSwap & hs);
+            ~ReadGuard              ();
+
+            const T *   operator -> () const {return ptr_;}
+            const T &   operator *  () const {return *ptr_;}
+            const T *   Get         () const {return ptr_;}
+            bool        Valid       () const {return ptr_ != nullptr;}
+
+        private:
+            ReadGuard               (const ReadGuard &); //guards are not copyable
+            ReadGuard & operator =  (const ReadGuard &);
+
+            const HotSwap &     hs_;
+            size_t              slot_;
+            const T *           ptr_;
+        };
+
+                HotSwap     ();
+        explicit HotSwap    (T * t);    //takes ownership of t
+                ~HotSwap    ();         //caller must ensure no guards are outstanding
+
+        void    Publish     (T * t);    //takes ownership of t, retires the old instance
+        size_t  Reclaim     ();         //deletes retired instances no reader can see; returns count
+        void    Synchronize ();         //blocks until every retired instance has been reclaimed
+
+        size_t  Epoch       () const {return epoch_.load();}
+        size_t  Retired     () const;
+
+    private:
+
+        HotSwap                 (const HotSwap &); //cells are not copyable
+        HotSwap & operator =    (const HotSwap &);
+
+        //one reader slot per cache line, so readers do not false-share
+        struct alignas(64) Slot
+        {
+            std::atomic<size_t> epoch_; //0 = idle, otherwise epoch announced by the reader
+        };
+
+        struct Retiree
+        {
+            T *     ptr_;
+            size_t  epoch_; //safe to delete once every active slot has reached this epoch
+        };
+
+        size_t  MinActive   () const; //smallest epoch announced by an active reader, 0 if none
+
+        std::atomic<T*>         current_;
+        std::atomic<size_t>     epoch_;
+        mutable Slot            slot_[maxReaders];
+
+        fsu::Vector<Retiree>    retired_;
+        mutable std::mutex      retireMutex_;
+
+    }; //end class HotSwap
+
+
+    //----
+    //ReadGuard implementations
+    //----
+
+    template < class T >
+    HotSwap<T>::ReadGuard::ReadGuard (const HotSwap & hs) : hs_(hs), slot_(0), ptr_(nullptr)
+    {
+        //start probing at a per-thread position so readers spread across slots
+        size_t start = std::hash<std::thread::id>()(std::this_thread::get_id()) % maxReaders;
+        for (;;)
+        {
+            for (size_t k = 0; k < maxReaders; ++k)
+            {
+                size_t i = (start + k) % maxReaders;
+                size_t idle = 0;
+                size_t e = hs_.epoch_.load();
+                if (hs_.slot_[i].epoch_.compare_exchange_strong(idle, e))
+                {
+                    slot_ = i;
+                    ptr_ = hs_.current_.load(); //must follow the announcement
+                    return;
+                }
+            }
+            std::this_thread::yield(); //every slot is busy
+        }
+    }
+
+    template < class T >
+    HotSwap<T>::ReadGuard::~ReadGuard ()
+    {
+        hs_.slot_[slot_].epoch_.store(0);
+    }
+
+
+    //----
+    //HotSwap implementations
+    //----
+
+    template < class T >
+    HotSwap<T>::HotSwap () : current_(nullptr), epoch_(1), retired_()
+    {
+        for (size_t i = 0; i < maxReaders; ++i)
+            slot_[i].epoch_.store(0);
+    }
+
+    template < class T >
+    HotSwap<T>::HotSwap (T * t) : current_(t), epoch_(1), retired_()
+    {
+        for (size_t i = 0; i < maxReaders; ++i)
+            slot_[i].epoch_.store(0);
+    }
+
+    template < class T >
+    HotSwap<T>::~HotSwap ()
+    {
+        for (size_t i = 0; i < retired_.Size(); ++i)
+            delete retired_[i].ptr_;
+        delete current_.load();
+    }
+
+    template < class T >
+    void HotSwap<T>::Publish (T * t)
+    {
+        T * old = current_.exchange(t);
+        size_t e = 1 + epoch_.fetch_add(1); //readers announcing e or later cannot see old
+        if (old != nullptr)
+        {
+            std::lock_guard<std::mutex> lock(retireMutex_);
+            Retiree r;
+            r.ptr_ = old;
+            r.epoch_ = e;
+            retired_.PushBack(r);
+        }
+        Reclaim();
+    }
+
+    template < class T >
+    size_t HotSwap<T>::Reclaim ()
+    {
+        fsu::Vector<T*> doomed;
+        {
+            std::lock_guard<std::mutex> lock(retireMutex_);
+            size_t min = MinActive();
+            size_t keep = 0;
+            for (size_t i = 0; i < retired_.Size(); ++i)
+            {
+                if (min == 0 || retired_[i].epoch_ <= min)
+                    doomed.PushBack(retired_[i].ptr_);
+                else
+                    retired_[keep++] = retired_[i]; //still visible to some reader
+            }
+            retired_.SetSize(keep);
+        }
+        //destroy outside the lock; a MovieMatch teardown is not cheap
+        for (size_t i = 0; i < doomed.Size(); ++i)
+            delete doomed[i];
+        return doomed.Size();
+    }
+
+    template < class T >
+    void HotSwap<T>::Synchronize ()
+    {
+        Reclaim();
+        while (Retired() > 0)
+        {
+            std::this_thread::yield();
+            Reclaim();
+        }
+    }
+
+    template < class T >
+    size_t HotSwap<T>::Retired () const
+    {
+        std::lock_guard<std::mutex> lock(retireMutex_);
+        return retired_.Size();
+    }
+
+    template < class T >
+    size_t HotSwap<T>::MinActive () const
+    {
+        size_t min = 0;
+        for (size_t i = 0; i < maxReaders; ++i)
+        {
+            size_t e = slot_[i].epoch_.load();
+            if (e != 0 && (min == 0 || e < min))
+                min = e;
+        }
+        return min;
+    }
+
+} //end namespace fsu
+
+#endif /* HOTSWAP_H */
@@ -14,6 +14,7 @@
 #include <primes.cpp>
 #include <hashfunctions.cpp>
 #include <timer.cpp>
+#include <xran.cpp>
 // */
 
 bool BATCH = 0;
@@ -154,6 +155,9 @@ int main(int argc, char* argv[])
         std::cout << "   A connecting path is:\n";
         mm.ShowPath(std::cout);
         std::cout << "   The path is minimal because it was found with BFS [ref graph theory].\n";
+        unsigned long long count = mm.PathCount(name.Cstr());
+        if (count > 1)
+          std::cout << "   It is one of " << count << " shortest paths.\n";
       }
     }
   } // end while
@@ -0,0 +1,402 @@
+/*
+    kbbench.cpp
+    Andrew J Wood
+    COP 4530
+
+    Benchmark driver for MovieMatch.  Loads a database, optionally renumbers
+    the vertices, times repeated breadth-first surveys from the base actor,
+    and times SharedMovies queries between the base actor and each co-star.
+    Each name hash function is timed on every name in the database, and
+    the bucket distribution of a table built with it is reported.  Name
+    lookups are timed before and after the names are frozen into a
+    minimal perfect hash.
+
+    usage: kbbench.x database 'Last, First' [order [reps [landmarks [labels [names]]]]]
+           order = load | bfs | degree | rcm | community   (default: load)
+           reps  = number of timed surveys                  (default: 10)
+           landmarks = landmark table file: loaded if it matches the
+                       database and order, otherwise built and saved there
+           labels    = label index file, mapped or built and saved likewise
+           names     = frozen name table file, loaded or built and saved likewise
+*/
+
+#include <moviematch.h>
+#include <bfsurvey.h>
+#include <cgraph.h>
+#include <xstring.h>
+#include <timer.h>
+#include <hashclasses.h>
+#include <hashtbl.h>
+
+// in lieu of makefile
+#include <xstring.cpp>
+#include <bitvect.cpp>
+#include <primes.cpp>
+#include <hashfunctions.cpp>
+#include <timer.cpp>
+#include <xran.cpp>
+// */
+
+typedef MovieMatch::Graph   Graph;
+typedef MovieMatch::Vertex  Vertex;
+
+// times reps surveys of g from v; reports the mean
+template < class G >
+void TimeSurvey (const char* label, const G& g, Vertex v, size_t reps)
+{
+  fsu::BFSurvey<G> bfs(g);
+  bfs.traceQue = 0;
+  fsu::Timer timer;
+  fsu::Instant time;
+  timer.EventReset();
+  for (size_t r = 0; r < reps; ++r)
+  {
+    bfs.Reset();
+    bfs.Search(v);
+  }
+  time = timer.EventTime();
+  std::cout << " " << label << " survey: ";
+  fsu::Instant(0, (long)(time.Get_useconds() / reps)).Write_mseconds(std::cout,3);
+  std::cout << " msec/survey (" << reps << " reps)\n";
+}
+
+// times hashing and looking up every name of mm with hash class H; analysis = 1 prints the bucket distribution
+template < class H >
+void TimeHash (const MovieMatch& mm, bool analysis = 0)
+{
+  H hash;
+  size_t n = mm.GetGraph().VrtxSize();
+  size_t bytes = 0;
+  for (Vertex v = 0; v < n; ++v)
+    bytes += mm.NameOf(v).Size();
+  fsu::Timer timer;
+  fsu::Instant time;
+  uint64_t sum = 0; // keeps the hash calls from being optimized away
+  timer.EventReset();
+  for (size_t r = 0; r < 10; ++r)
+    for (Vertex v = 0; v < n; ++v)
+      sum += hash(mm.NameOf(v));
+  time = timer.EventTime();
+  double usec = (double)time.Get_useconds() / 10;
+
+  fsu::HashTable<MovieMatch::Name,Vertex,H> table(n);
+  for (Vertex v = 0; v < n; ++v)
+    table.Insert(mm.NameOf(v), v);
+  Vertex w;
+  size_t found = 0;
+  timer.EventReset();
+  for (Vertex v = 0; v < n; ++v)
+    found += table.Retrieve(mm.NameOf(v), w);
+  time = timer.EventTime();
+  std::streamsize precision = std::cout.precision();
+  std::cout << " " << std::setw(6) << hash.Name() << " hash: "
+            << std::setw(8) << std::setprecision(3) << usec * 1000 / (n ? n : 1) << " nsec/name, "
+            << std::setw(8) << std::setprecision(4) << (usec > 0 ? bytes / usec : 0) << " MB/sec, "
+            << "max bucket " << table.MaxBucketSize() << ", lookup "
+            << std::setw(6) << std::setprecision(3) << (double)time.Get_useconds() * 1000 / (n ? n : 1) << " nsec/name"
+            << ((found == n) ? "" : " ** lookup failure") << '\n';
+  std::cout.precision(precision);
+  volatile uint64_t sink = sum;
+  (void)sink;
+  if (analysis)
+    table.Analysis(std::cout);
+}
+
+// times looking up every name of mm; names that are not in the database must not be found
+void TimeLookup (const char* label, const MovieMatch& mm)
+{
+  size_t n = mm.GetGraph().VrtxSize();
+  fsu::Vector<MovieMatch::Name> other(n < 1000 ? n : 1000);
+  for (size_t k = 0; k < other.Size(); ++k)
+    other[k] = mm.NameOf((Vertex)k) + " (II)";
+  fsu::Timer timer;
+  fsu::Instant time;
+  Vertex w;
+  size_t wrong = 0;
+  timer.EventReset();
+  for (Vertex v = 0; v < n; ++v)
+    if (!mm.Lookup(mm.NameOf(v), w) || w != v)
+      ++wrong;
+  time = timer.EventTime();
+  for (size_t k = 0; k < other.Size(); ++k)
+    if (mm.Lookup(other[k], w) && mm.NameOf(w) != other[k])
+      ++wrong;
+  std::cout << " " << label << " lookup: " << (double)time.Get_useconds() * 1000 / (n ? n : 1) << " nsec/name"
+            << ((wrong == 0) ? "" : " ** lookup failure") << '\n';
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc < 3)
+  {
+    std::cout << "command line arguments:\n"
+              << " 1 (required): database file name\n"
+              << " 2 (required): root actor name (delimited with single quotes \'Last, First\')\n"
+              << " 3 (optional): vertex order: load | bfs | degree | rcm | community\n"
+              << " 4 (optional): number of timed surveys (default 10)\n"
+              << " 5 (optional): landmark table file\n"
+              << " 6 (optional): label index file\n"
+              << " 7 (optional): frozen name table file\n";
+    return 0;
+  }
+  fsu::VertexOrder order = fsu::loadOrder;
+  if (argc > 3 && !fsu::ParseVertexOrder(argv[3], order))
+  {
+    std::cout << " ** kbbench: unknown vertex order \'" << argv[3] << "\'\n";
+    return EXIT_FAILURE;
+  }
+  size_t reps = 10;
+  if (argc > 4)
+    reps = (size_t)atol(argv[4]);
+  if (reps == 0) reps = 1;
+
+  MovieMatch mm;
+  fsu::Timer timer;
+  fsu::Instant time;
+
+  timer.EventReset();
+  if (!mm.Load(argv[1]))
+  {
+    std::cout << " ** kbbench: Failure to Load " << argv[1] << '\n';
+    return EXIT_FAILURE;
+  }
+  time = timer.EventTime();
+  std::cout << " Load time: ";
+  time.Write_seconds(std::cout,2);
+  std::cout << " sec\n";
+
+  // name hash functions on the names just loaded; the last is the one MovieMatch uses
+  TimeHash< hashclass::Simple<MovieMatch::Name> >(mm);
+  TimeHash< hashclass::ModP<MovieMatch::Name> >(mm);
+  TimeHash< hashclass::MM<MovieMatch::Name> >(mm);
+  TimeHash< hashclass::KISS<MovieMatch::Name> >(mm);
+  TimeHash< hashclass::Murmur<MovieMatch::Name> >(mm);
+  TimeHash< MovieMatch::Hash >(mm, 1);
+
+  timer.EventReset();
+  mm.Reorder(order);
+  time = timer.EventTime();
+  std::cout << " Reorder (" << (3 < argc ? argv[3] : "load") << ") time: ";
+  time.Write_seconds(std::cout,2);
+  std::cout << " sec\n";
+
+  timer.EventReset();
+  if (!mm.Init(argv[2]))
+  {
+    std::cout << " ** kbbench: failure to Init " << argv[2] << '\n';
+    return EXIT_FAILURE;
+  }
+  time = timer.EventTime();
+  std::cout << " Init time: ";
+  time.Write_seconds(std::cout,2);
+  std::cout << " sec\n";
+
+  // the name dictionary, then frozen into a minimal perfect hash
+  TimeLookup("hash table", mm);
+  timer.EventReset();
+  bool frozen = argc > 7 && mm.LoadNames(argv[7]);
+  if (!frozen)
+  {
+    if (!mm.FreezeNames())
+      return EXIT_FAILURE;
+    if (argc > 7)
+      mm.SaveNames(argv[7]);
+  }
+  time = timer.EventTime();
+  const MovieMatch::FrozenAA & table = mm.GetFrozenNames();
+  std::cout << " Name table " << (frozen ? "load" : "freeze") << " time: ";
+  time.Write_mseconds(std::cout,3);
+  std::cout << " msec, " << table.Levels() << " levels, " << table.Spilled() << " spilled, "
+            << (double)table.FunctionBits() / (table.Size() ? table.Size() : 1) << " bits/name, "
+            << table.ByteSize() << " bytes\n";
+  TimeLookup("perfect hash", mm);
+
+  timer.EventReset();
+  mm.Statistics(std::cout);
+  time = timer.EventTime();
+  std::cout << " Statistics time: ";
+  time.Write_mseconds(std::cout,3);
+  std::cout << " msec\n";
+  mm.Statistics(std::cout, 1);
+
+  // connected components; relabeling them is the part Load pays for
+  {
+    fsu::Components<Vertex> comp;
+    timer.EventReset();
+    comp.Build(mm.GetGraph());
+    time = timer.EventTime();
+    mm.ComponentReport(std::cout);
+    std::cout << " Components time: ";
+    time.Write_mseconds(std::cout,3);
+    std::cout << " msec\n";
+  }
+
+  // most central actors
+  fsu::Vector<MovieMatch::Centrality> top;
+  timer.EventReset();
+  mm.CentralActors(10, top);
+  time = timer.EventTime();
+  std::cout << " CentralActors time: ";
+  time.Write_seconds(std::cout,2);
+  std::cout << " sec\n";
+  for (size_t r = 0; r < top.Size(); ++r)
+    std::cout << "   " << top[r].Average() << "  " << mm.NameOf(top[r].vertex_) << '\n';
+
+  // bridges, estimated from a sample of source actors
+  fsu::Vector<MovieMatch::Bridge> bridges;
+  timer.EventReset();
+  mm.Bridges(10, bridges, 256, 1);
+  time = timer.EventTime();
+  std::cout << " Bridges (256 sources) time: ";
+  time.Write_seconds(std::cout,2);
+  std::cout << " sec\n";
+  for (size_t r = 0; r < bridges.Size(); ++r)
+    std::cout << "   " << (size_t)bridges[r].score_ << "  " << mm.NameOf(bridges[r].vertex_) << '\n';
+
+  // diameter of the largest component, in KB numbers
+  Vertex far1, far2;
+  size_t sweeps;
+  timer.EventReset();
+  size_t diameter = mm.Diameter(far1, far2, sweeps);
+  time = timer.EventTime();
+  std::cout << " Diameter: " << diameter << " (" << mm.NameOf(far1) << " to " << mm.NameOf(far2)
+            << "), " << sweeps << " surveys, ";
+  time.Write_seconds(std::cout,2);
+  std::cout << " sec\n";
+
+  Vertex base;
+  mm.Lookup(argv[2], base);
+  TimeSurvey("sorted array graph", mm.GetGraph(), base, reps);
+
+  timer.EventReset();
+  fsu::CompressedGraph<Vertex> cg(mm.GetGraph());
+  time = timer.EventTime();
+  size_t entries = 2 * cg.EdgeSize();
+  std::cout << " Compress time: ";
+  time.Write_seconds(std::cout,2);
+  std::cout << " sec, " << cg.ByteSize() << " bytes vs " << mm.GetGraph().ByteSize()
+            << " sorted array (" << (double)cg.ByteSize() / (entries ? entries : 1) << " vs "
+            << (double)mm.GetGraph().ByteSize() / (entries ? entries : 1) << " bytes/entry, offsets included)\n";
+  TimeSurvey("compressed graph", cg, base, reps);
+
+  // shared movies of the base actor with every actor two steps away
+  fsu::Vector<MovieMatch::VrtxPair> pairs;
+  fsu::Vector<char> seen(mm.GetGraph().VrtxSize(), 0);
+  for (Graph::AdjIterator i = mm.GetGraph().Begin(base); i != mm.GetGraph().End(base); ++i)
+  {
+    for (Graph::AdjIterator j = mm.GetGraph().Begin(*i); j != mm.GetGraph().End(*i); ++j)
+    {
+      if (*j != base && !seen[*j])
+      {
+        seen[*j] = 1;
+        pairs.PushBack(MovieMatch::VrtxPair(base, *j));
+      }
+    }
+  }
+  fsu::Vector<size_t> offset;
+  MovieMatch::VrtxVector movies;
+  timer.EventReset();
+  for (size_t r = 0; r < reps; ++r)
+    mm.SharedMovies(pairs, offset, movies);
+  time = timer.EventTime();
+  std::cout << " SharedMovies batch: " << pairs.Size() << " pairs, "
+            << movies.Size() << " movies, "
+            << (double)time.Get_useconds() / (reps * (pairs.Size() ? pairs.Size() : 1))
+            << " usec/pair\n";
+
+  // actor-to-actor distances between random actors through the landmark oracle
+  timer.EventReset();
+  bool loaded = argc > 5 && mm.LoadOracle(argv[5]);
+  if (!loaded)
+  {
+    mm.BuildOracle(16);
+    if (argc > 5)
+      mm.SaveOracle(argv[5]);
+  }
+  time = timer.EventTime();
+  std::cout << " Oracle " << (loaded ? "load" : "build") << " time: ";
+  time.Write_seconds(std::cout,2);
+  std::cout << " sec\n";
+  fsu::Random_uint64_t random(1);
+  fsu::Vector<MovieMatch::Name> names;
+  while (names.Size() < 2000)
+    names.PushBack(mm.NameOf((Vertex)random(0, mm.GetGraph().VrtxSize())));
+  size_t queries = 0, tight = 0;
+  long upper;
+  timer.EventReset();
+  for (size_t k = 0; k + 1 < names.Size(); k += 2)
+  {
+    long lower = mm.ActorDistance(names[k].Cstr(), names[k+1].Cstr(), upper);
+    if (lower >= 0)
+    {
+      ++queries;
+      if (lower == upper) ++tight;
+    }
+  }
+  time = timer.EventTime();
+  std::cout << " Oracle bounds: " << queries << " actor pairs, " << tight << " exact, "
+            << (double)time.Get_useconds() / (queries ? queries : 1) << " usec/pair\n";
+  timer.EventReset();
+  for (size_t k = 0; k + 1 < names.Size(); k += 2)
+    mm.ActorDistance(names[k].Cstr(), names[k+1].Cstr());
+  time = timer.EventTime();
+  std::cout << " Oracle exact:  " << (double)time.Get_useconds() / (queries ? queries : 1) << " usec/pair\n";
+
+  // exact distances for the same pairs from the 2-hop label index; the oracle's answers are the reference
+  fsu::Vector<long> expected;
+  for (size_t k = 0; k + 1 < names.Size(); k += 2)
+    expected.PushBack(mm.ActorDistance(names[k].Cstr(), names[k+1].Cstr()));
+  const MovieMatch::Labels & labels = mm.GetLabels();
+  size_t vertices = mm.GetGraph().VrtxSize();
+  timer.EventReset();
+  if (argc > 6 && mm.LoadLabels(argv[6]))
+  {
+    time = timer.EventTime();
+    std::cout << " Label index map time: ";
+    time.Write_seconds(std::cout,2);
+    std::cout << " sec, ";
+  }
+  else
+  {
+    if (!mm.BuildLabels())
+      return EXIT_FAILURE;
+    if (argc > 6)
+      mm.SaveLabels(argv[6]);
+    std::cout << " Label index build time: ";
+    labels.BuildTime().Write_seconds(std::cout,2);
+    std::cout << " sec, ";
+  }
+  std::cout << labels.Entries() << " entries ("
+            << (double)labels.Entries() / (vertices ? vertices : 1) << " per vertex), "
+            << labels.ByteSize() << " bytes\n";
+  timer.EventReset();
+  size_t mismatch = 0;
+  for (size_t r = 0; r < reps; ++r)
+  {
+    for (size_t k = 0; k + 1 < names.Size(); k += 2)
+    {
+      if (mm.ActorDistance(names[k].Cstr(), names[k+1].Cstr()) != expected[k/2])
+        ++mismatch;
+    }
+  }
+  time = timer.EventTime();
+  std::cout << " Label exact:   " << (double)time.Get_useconds() / (reps * (queries ? queries : 1)) << " usec/pair\n";
+  if (mismatch > 0)
+  {
+    std::cout << " ** kbbench: label index and oracle disagree on " << mismatch << " queries\n";
+    return EXIT_FAILURE;
+  }
+
+  // the two representations must agree on every distance
+  fsu::BFSurvey<Graph> lbfs(mm.GetGraph());
+  fsu::BFSurvey< fsu::CompressedGraph<Vertex> > cbfs(cg);
+  lbfs.traceQue = cbfs.traceQue = 0;
+  lbfs.Search(base);
+  cbfs.Search(base);
+  if (lbfs.Distance() != cbfs.Distance())
+  {
+    std::cout << " ** kbbench: compressed graph distances differ\n";
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
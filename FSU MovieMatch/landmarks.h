@@ -0,0 +1,397 @@
+/*
+    landmarks.h
+    Andrew J Wood
+    COP 4530
+
+    Defines and implements Landmarks, a distance oracle for arbitrary pairs
+    of vertices.
+
+    One survey from each of L landmark vertices records d(l, v) for every v,
+    one byte per entry, stored row by row (the L distances of a vertex are
+    adjacent), so a query reads two rows of L bytes.  By the triangle
+    inequality, for every landmark l
+
+        |d(l,s) - d(l,t)|  <=  d(s,t)  <=  d(l,s) + d(l,t)
+
+    Lower(s,t) and Upper(s,t) take the best of these over the landmarks in
+    O(L).  A byte holds distances below tooFar (254); farther vertices are
+    stored as tooFar and skipped by the bounds, and unreachable ones as
+    unreached (255).  If exactly one of s, t is reached from some landmark,
+    they are in different components.
+
+    Distance(s,t) is exact: a bidirectional BFS that expands the smaller
+    frontier a whole level at a time, starting with best = Upper(s,t).  A
+    vertex x found at depth a from s is not expanded when
+    a + Lower(x,t) >= best, since no path through it can beat best (and
+    symmetrically from t).  The search stops as soon as the two depths
+    add up to best - 1 or best meets Lower(s,t).  Scratch arrays are
+    stamped, so a query costs only the vertices it touches; Distance is
+    therefore not reentrant.
+
+    Landmarks are chosen by degree (Choose, skipping candidates within two
+    hops of one already chosen, so they spread over the graph) or supplied by
+    the client (Build), for example the most central actors.
+
+    Save / Load write the table in a binary file: a header (magic, version,
+    |V|, |E|, a fingerprint of the degree sequence), the landmark ids, then
+    the rows.  Load refuses a table made for a different graph or vertex
+    numbering.  Integers are written in host byte order.
+
+    Note that the code is self-documenting.
+ */
+
+#ifndef LANDMARKS_H
+#define LANDMARKS_H
+
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector.h>
+#include <vrtxorder.h>
+#include <bfsurvey.h>
+
+namespace fsu {
+
+    template < class G >
+    class Landmarks
+    {
+    public:
+
+        typedef G                           Graph;
+        typedef typename Graph::Vertex      Vertex;
+        typedef typename Graph::AdjIterator AdjIterator;
+        typedef uint8_t                     Entry; //one table entry
+
+        static const Entry  tooFar      = 254;
+        static const Entry  unreached   = 255;
+
+        explicit Landmarks  (const Graph & g);
+
+        template < class P >
+        void    Choose      (size_t count, P & candidate); //highest-degree candidates, spread apart
+        void    Build       (const fsu::Vector<Vertex> & landmarks);
+        void    Relabel     (const fsu::Vector<Vertex> & perm); //follows the graph's renumbering, perm[old] = new
+        void    Clear       ();
+
+        size_t  Lower       (Vertex s, Vertex t) const; //InfiniteDistance() if s and t are not connected
+        size_t  Upper       (Vertex s, Vertex t) const; //InfiniteDistance() if no landmark reaches both
+        size_t  Distance    (Vertex s, Vertex t);       //exact; InfiniteDistance() if not connected
+
+        size_t  Count       () const {return landmark_.Size();}
+        Vertex  Landmark    (size_t l) const {return landmark_[l];}
+        size_t  Touched     () const {return touched_;} //vertices the last Distance query discovered
+        size_t  ByteSize    () const {return table_.Size() + landmark_.Size() * sizeof(Vertex);}
+        size_t  InfiniteDistance () const {return 1 + g_.EdgeSize();}
+
+        bool    Save        (const char * filename) const;
+        bool    Load        (const char * filename);
+
+    private:
+
+        Landmarks               (const Landmarks &); //g_ is a reference
+        Landmarks & operator =  (const Landmarks &);
+
+        const Entry * Row    (Vertex v) const {return table_.Begin() + (size_t)v * landmark_.Size();}
+        uint64_t    Fingerprint () const; //FNV-1a over the degree sequence
+        size_t      Level       (fsu::Vector<Vertex> & frontier, size_t depth,
+                                 fsu::Vector<uint32_t> & stamp, fsu::Vector<Vertex> & dist,
+                                 const fsu::Vector<uint32_t> & otherStamp, const fsu::Vector<Vertex> & otherDist,
+                                 Vertex goal, size_t best);
+
+        const Graph &           g_;
+        fsu::Vector<Vertex>     landmark_;
+        fsu::Vector<Entry>   table_;     //table_[v * Count() + l] = d(landmark l, v)
+
+        //scratch for Distance
+        fsu::Vector<uint32_t>   stampS_, stampT_;
+        fsu::Vector<Vertex>     distS_, distT_;
+        fsu::Vector<Vertex>     frontS_, frontT_, next_;
+        uint32_t                mark_;
+        size_t                  touched_;
+
+    }; //end class Landmarks
+
+
+    //----
+    //Landmarks implementations
+    //----
+
+    template < class G >
+    const typename Landmarks<G>::Entry Landmarks<G>::tooFar;
+
+    template < class G >
+    const typename Landmarks<G>::Entry Landmarks<G>::unreached;
+
+    template < class G >
+    Landmarks<G>::Landmarks (const Graph & g)
+    :   g_(g), landmark_(), table_(), stampS_(), stampT_(), distS_(), distT_(),
+        frontS_(), frontT_(), next_(), mark_(0), touched_(0)
+    {}
+
+    template < class G >
+    template < class P >
+    void Landmarks<G>::Choose (size_t count, P & candidate)
+    {
+        fsu::Vector<Vertex> byDegree;
+        SortByDegree(g_, byDegree, 1);
+        fsu::Vector<char> blocked(g_.VrtxSize(), 0);
+        fsu::Vector<Vertex> chosen;
+        AdjIterator i, j;
+        for (size_t r = 0; r < byDegree.Size() && chosen.Size() < count; ++r)
+        {
+            Vertex v = byDegree[r];
+            if (blocked[v] || !candidate(v))
+                continue;
+            chosen.PushBack(v);
+            blocked[v] = 1;
+            for (i = g_.Begin(v); i != g_.End(v); ++i)
+            {
+                blocked[*i] = 1;
+                for (j = g_.Begin(*i); j != g_.End(*i); ++j)
+                    blocked[*j] = 1;
+            }
+        }
+        Build(chosen);
+    }
+
+    template < class G >
+    void Landmarks<G>::Build (const fsu::Vector<Vertex> & landmarks)
+    {
+        size_t n = g_.VrtxSize(), L = landmarks.Size();
+        landmark_ = landmarks;
+        table_.SetSize(n * L);
+        fsu::BFSurvey<Graph> bfs(g_);
+        bfs.traceQue = 0;
+        for (size_t l = 0; l < L; ++l)
+        {
+            bfs.Reset();
+            bfs.Search(landmark_[l]);
+            for (size_t v = 0; v < n; ++v)
+            {
+                size_t d = bfs.Distance()[v];
+                table_[v * L + l] = (d == bfs.InfiniteDistance()) ? unreached : (d < tooFar ? (Entry)d : tooFar);
+            }
+        }
+    }
+
+    template < class G >
+    void Landmarks<G>::Relabel (const fsu::Vector<Vertex> & perm)
+    {
+        size_t L = landmark_.Size();
+        if (L == 0)
+            return;
+        fsu::Vector<Entry> table(table_.Size());
+        for (size_t v = 0; v < perm.Size(); ++v)
+            memcpy(table.Begin() + (size_t)perm[v] * L, table_.Begin() + v * L, L);
+        table_.Swap(table);
+        for (size_t l = 0; l < L; ++l)
+            landmark_[l] = perm[landmark_[l]];
+    }
+
+    template < class G >
+    void Landmarks<G>::Clear ()
+    {
+        landmark_.Clear();
+        table_.Clear();
+    }
+
+    template < class G >
+    size_t Landmarks<G>::Lower (Vertex s, Vertex t) const
+    {
+        const Entry * a = Row(s), * b = Row(t);
+        size_t lower = 0;
+        for (size_t l = 0; l < landmark_.Size(); ++l)
+        {
+            if (a[l] == unreached || b[l] == unreached)
+            {
+                if (a[l] != b[l])
+                    return InfiniteDistance(); //one is in the landmark's component, the other is not
+                continue;
+            }
+            if (a[l] == tooFar || b[l] == tooFar)
+                continue;
+            size_t d = a[l] > b[l] ? a[l] - b[l] : b[l] - a[l];
+            if (d > lower)
+                lower = d;
+        }
+        return lower;
+    }
+
+    template < class G >
+    size_t Landmarks<G>::Upper (Vertex s, Vertex t) const
+    {
+        const Entry * a = Row(s), * b = Row(t);
+        size_t upper = InfiniteDistance();
+        for (size_t l = 0; l < landmark_.Size(); ++l)
+        {
+            if (a[l] >= tooFar || b[l] >= tooFar)
+                continue;
+            size_t d = (size_t)a[l] + b[l];
+            if (d < upper)
+                upper = d;
+        }
+        return upper;
+    }
+
+    //expands one level of a frontier at the given depth; returns the new best
+    template < class G >
+    size_t Landmarks<G>::Level (fsu::Vector<Vertex> & frontier, size_t depth,
+                                fsu::Vector<uint32_t> & stamp, fsu::Vector<Vertex> & dist,
+                                const fsu::Vector<uint32_t> & otherStamp, const fsu::Vector<Vertex> & otherDist,
+                                Vertex goal, size_t best)
+    {
+        next_.Clear();
+        AdjIterator i;
+        for (size_t k = 0; k < frontier.Size(); ++k)
+        {
+            Vertex x = frontier[k];
+            for (i = g_.Begin(x); i != g_.End(x); ++i)
+            {
+                Vertex y = *i;
+                if (stamp[y] == mark_)
+                    continue;
+                stamp[y] = mark_;
+                dist[y] = (Vertex)(depth + 1);
+                ++touched_;
+                if (otherStamp[y] == mark_ && depth + 1 + otherDist[y] < best)
+                    best = depth + 1 + otherDist[y]; //the searches meet at y
+                if (depth + 1 + Lower(y, goal) >= best)
+                    continue; //no path through y beats best
+                next_.PushBack(y);
+            }
+        }
+        frontier.Swap(next_);
+        return best;
+    }
+
+    template < class G >
+    size_t Landmarks<G>::Distance (Vertex s, Vertex t)
+    {
+        touched_ = 0;
+        if (s == t)
+            return 0;
+        size_t lower = Lower(s, t), best = Upper(s, t);
+        if (lower >= best)
+            return best; //includes different components
+
+        size_t n = g_.VrtxSize();
+        if (stampS_.Size() != n)
+        {
+            stampS_.SetSize(n, 0);
+            stampT_.SetSize(n, 0);
+            distS_.SetSize(n);
+            distT_.SetSize(n);
+            mark_ = 0;
+        }
+        if (++mark_ == 0) //stamps wrapped; start over
+        {
+            for (size_t x = 0; x < n; ++x)
+                stampS_[x] = stampT_[x] = 0;
+            mark_ = 1;
+        }
+        stampS_[s] = stampT_[t] = mark_;
+        distS_[s] = distT_[t] = 0;
+        frontS_.Clear();
+        frontT_.Clear();
+        frontS_.PushBack(s);
+        frontT_.PushBack(t);
+
+        //a path shorter than best would need depthS + depthT + 1 <= best - 1 edges on the next level
+        size_t depthS = 0, depthT = 0;
+        while (!frontS_.Empty() && !frontT_.Empty() && depthS + depthT + 1 < best && lower < best)
+        {
+            if (frontS_.Size() <= frontT_.Size())
+                best = Level(frontS_, depthS++, stampS_, distS_, stampT_, distT_, t, best);
+            else
+                best = Level(frontT_, depthT++, stampT_, distT_, stampS_, distS_, s, best);
+        }
+        return best;
+    }
+
+    template < class G >
+    uint64_t Landmarks<G>::Fingerprint () const
+    {
+        uint64_t h = 14695981039346656037ULL;
+        for (Vertex v = 0; v < g_.VrtxSize(); ++v)
+        {
+            h ^= (uint64_t)g_.OutDegree(v);
+            h *= 1099511628211ULL;
+        }
+        return h;
+    }
+
+    template < class G >
+    bool Landmarks<G>::Save (const char * filename) const
+    {
+        std::ofstream out(filename, std::ios::out | std::ios::binary);
+        if (!out)
+        {
+            std::cerr << " ** Landmarks::Save: cannot open " << filename << '\n';
+            return 0;
+        }
+        uint32_t version = 1, count = (uint32_t)landmark_.Size();
+        uint64_t n = g_.VrtxSize(), e = g_.EdgeSize(), f = Fingerprint();
+        out.write("KBLM", 4);
+        out.write((const char*)&version, sizeof(version));
+        out.write((const char*)&n, sizeof(n));
+        out.write((const char*)&e, sizeof(e));
+        out.write((const char*)&f, sizeof(f));
+        out.write((const char*)&count, sizeof(count));
+        for (size_t l = 0; l < landmark_.Size(); ++l)
+        {
+            uint64_t id = landmark_[l];
+            out.write((const char*)&id, sizeof(id));
+        }
+        out.write((const char*)table_.Begin(), table_.Size());
+        return (bool)out;
+    }
+
+    template < class G >
+    bool Landmarks<G>::Load (const char * filename)
+    {
+        std::ifstream in(filename, std::ios::in | std::ios::binary);
+        if (!in)
+            return 0; //no saved table; not an error
+        char magic[4];
+        uint32_t version, count;
+        uint64_t n, e, f;
+        in.read(magic, 4);
+        in.read((char*)&version, sizeof(version));
+        in.read((char*)&n, sizeof(n));
+        in.read((char*)&e, sizeof(e));
+        in.read((char*)&f, sizeof(f));
+        in.read((char*)&count, sizeof(count));
+        if (!in || memcmp(magic, "KBLM", 4) != 0 || version != 1)
+        {
+            std::cerr << " ** Landmarks::Load: " << filename << " is not a landmark table\n";
+            return 0;
+        }
+        if (n != g_.VrtxSize() || e != g_.EdgeSize() || f != Fingerprint())
+        {
+            std::cerr << " ** Landmarks::Load: " << filename << " was built for a different graph or vertex order\n";
+            return 0;
+        }
+        fsu::Vector<Vertex> landmark(count);
+        for (size_t l = 0; l < count; ++l)
+        {
+            uint64_t id;
+            in.read((char*)&id, sizeof(id));
+            landmark[l] = (Vertex)id;
+        }
+        fsu::Vector<Entry> table(n * count);
+        in.read((char*)table.Begin(), table.Size());
+        if (!in)
+        {
+            std::cerr << " ** Landmarks::Load: " << filename << " is truncated\n";
+            return 0;
+        }
+        landmark_.Swap(landmark);
+        table_.Swap(table);
+        return 1;
+    }
+
+} //end namespace fsu
+
+#endif /* LANDMARKS_H */
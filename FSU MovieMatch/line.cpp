@@ -1,10 +1,11 @@
 /*
    implements the private method
  
-   static MovieMatch::Line( std::istream& , fsu::Vector<Name>& );
+   static BasicMovieMatch<N>::Line( std::istream& , fsu::Vector<Name>& );
 */
 
-void MovieMatch::Line (std::istream& is, fsu::Vector<Name>& movie)
+template < typename N >
+void BasicMovieMatch<N>::Line (std::istream& is, fsu::Vector<Name>& movie)
 {
   movie.Clear();
   fsu::String line;
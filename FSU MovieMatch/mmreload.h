@@ -0,0 +1,152 @@
+/*
+    mmreload.h
+    Andrew J Wood
+    COP 4530
+
+    Defines and implements LiveMovieMatch, a MovieMatch that can be refreshed
+    without restarting the process.
+
+    A LiveMovieMatch holds its MovieMatch in a HotSwap cell.  Reload() builds a
+    complete new MovieMatch (Load + Init: graph, names, hint index, survey) off
+    to the side and publishes it only if both steps succeed; queries that are
+    in flight keep using the instance they pinned, which is reclaimed once the
+    last of them finishes.  Watch() starts a background thread that polls the
+    database file and reloads whenever its modification time or size changes.
+
+    Readers use the reentrant const query methods of MovieMatch:
+
+        LiveMovieMatch::Reader r(live.Cell());
+        MovieMatch::List path;
+        long kbn = r->MovieDistance(name, path);
+
+    Note that the code is self-documenting.
+ */
+
+#ifndef MMRELOAD_H
+#define MMRELOAD_H
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <sys/stat.h>
+#include <xstring.h>
+#include <moviematch.h>
+#include <hotswap.h>
+
+class LiveMovieMatch
+{
+public:
+
+    typedef fsu::HotSwap<MovieMatch>        CellType;
+    typedef CellType::ReadGuard             Reader;
+
+            LiveMovieMatch  (const char * filename, const char * actor);
+            ~LiveMovieMatch ();
+
+    bool    Reload          ();                         //build and publish a new instance; 0 leaves the old one live
+    void    Watch           (size_t periodMs = 1000);   //start polling the database file
+    void    Unwatch         ();                         //stop polling; waits for a reload in progress
+
+    const CellType &    Cell        () const {return cell_;}
+    size_t              Generation  () const {return generation_.load();} //number of successful loads
+
+private:
+
+    LiveMovieMatch  (const LiveMovieMatch &); //not copyable
+    LiveMovieMatch & operator = (const LiveMovieMatch &);
+
+    bool    Stamp           (long & mtime, long & size) const; //reads the file's modification stamp
+    void    WatchLoop       (size_t periodMs);
+
+    fsu::String             filename_;
+    fsu::String             actor_;
+    CellType                cell_;
+    std::atomic<size_t>     generation_;
+    std::mutex              reloadMutex_;   //one build at a time
+    std::atomic<bool>       watching_;
+    std::thread             watcher_;
+
+}; //end class LiveMovieMatch
+
+
+LiveMovieMatch::LiveMovieMatch (const char * filename, const char * actor)
+:   filename_(filename), actor_(actor), cell_(), generation_(0), reloadMutex_(), watching_(0), watcher_()
+{}
+
+LiveMovieMatch::~LiveMovieMatch ()
+{
+    Unwatch();
+    cell_.Synchronize();
+}
+
+bool LiveMovieMatch::Reload ()
+{
+    std::lock_guard<std::mutex> lock(reloadMutex_);
+
+    MovieMatch * mm = new MovieMatch;
+    if (!mm->Load(filename_.Cstr()) || !mm->Init(actor_.Cstr()))
+    {
+        std::cerr << " ** LiveMovieMatch: reload of " << filename_ << " failed; keeping current database\n";
+        delete mm;
+        return 0;
+    }
+    cell_.Publish(mm); //old instance is reclaimed when its last reader leaves
+    ++generation_;
+    return 1;
+}
+
+void LiveMovieMatch::Watch (size_t periodMs)
+{
+    if (watching_.exchange(1))
+        return; //already watching
+    watcher_ = std::thread(&LiveMovieMatch::WatchLoop, this, periodMs);
+}
+
+void LiveMovieMatch::Unwatch ()
+{
+    watching_.store(0);
+    if (watcher_.joinable())
+        watcher_.join();
+}
+
+bool LiveMovieMatch::Stamp (long & mtime, long & size) const
+{
+    struct stat st;
+    if (stat(filename_.Cstr(), &st) != 0)
+        return 0; //file is missing, possibly mid-replace
+    mtime = (long)st.st_mtime;
+    size = (long)st.st_size;
+    return 1;
+}
+
+void LiveMovieMatch::WatchLoop (size_t periodMs)
+{
+    long mtime = 0, size = 0;
+    bool known = Stamp(mtime, size);
+    while (watching_.load())
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(periodMs));
+
+        long newMtime = 0, newSize = 0;
+        if (!Stamp(newMtime, newSize))
+            continue;
+        if (known && newMtime == mtime && newSize == size)
+        {
+            cell_.Reclaim(); //let go of instances whose readers have finished
+            continue;
+        }
+
+        //file changed; wait one more period so a writer can finish, then reload
+        std::this_thread::sleep_for(std::chrono::milliseconds(periodMs));
+        if (!Stamp(mtime, size) || mtime != newMtime || size != newSize)
+        {
+            known = 0; //still changing, look again next period
+            continue;
+        }
+        known = 1;
+        Reload();
+    }
+}
+
+#endif /* MMRELOAD_H */
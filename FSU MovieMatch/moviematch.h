@@ -10,11 +10,13 @@
     The user will be able to determine any selected actor's Kevin Bacon number!
  
     The following technologies are used in the implementation:
-        -Graphs
+        -Graphs (frozen into sorted adjacency arrays after Load)
         -Graph Search and Survey
+        -Connected components (lock-free union-find at Load)
         -Path Computation in Graphs
-        -Associative Arrays [implemented via hash tables]
-        -Generic sort algorithms (specifically, heap sort)
+        -Landmark distance oracle and 2-hop label index for arbitrary actor pairs
+        -Associative Arrays [implemented via hash tables; frozen into a minimal perfect hash on request]
+        -Generic sort algorithms (heap sort, and case-folded MSD radix sort for names)
         -Generic binary search
  
     Note that the code is self-documenting.
@@ -26,18 +28,35 @@
 
 #include <xstring.h>
 #include <cstdlib>
+#include <cstdint>
+#include <limits>
 #include <graph.h>
+#include <csrgraph.h>
 #include <bfsurvey.h>
 #include <vector.h>
 #include <hashclasses.h>
 #include <hashtbl.h>
+#include <perfhash.h>
 #include <graph_util.h>
 #include <survey_util.h>
 #include <list.h>
 #include <cctype>
 #include <genalg.h>
 #include <gheap.h>
+#include <gsort.h>
+#include <gpsort.h>
+#include <gradix.h>
 #include <gbsearch.h>
+#include <vrtxorder.h>
+#include <pair.h>
+#include <spaths.h>
+#include <xran.h>
+#include <closeness.h>
+#include <ecc.h>
+#include <components.h>
+#include <betweenness.h>
+#include <landmarks.h>
+#include <pll.h>
 
 
 //class for sorting case insensitve strings
@@ -57,52 +76,190 @@ public:
     }
 };
 
+//Load and Reorder keep the sorted neighbor order of vertices of at least this degree for ShowStar
+const size_t starCacheDegree = 128;
+
+//maps each char to a byte so that bytes compare as CaseInsensitiveLessThan compares chars
+class CaseInsensitiveRank
+{
+public:
+    CaseInsensitiveRank ()
+    {
+        //rank_[c] = number of distinct tolower values below tolower(c)
+        //(tolower of a negative char differs between libraries, so no fixed offset works)
+        bool present[384] = {0}; //tolower of a char is in -128 .. 255
+        for (int c = 0; c < 256; ++c)
+            present[tolower((char)c) + 128] = 1;
+        uint8_t below[384];
+        int rank = 0;
+        for (int f = 0; f < 384; ++f)
+        {
+            below[f] = (uint8_t)rank;
+            rank += present[f];
+        }
+        for (int c = 0; c < 256; ++c)
+            rank_[c] = below[tolower((char)c) + 128];
+    }
+
+    uint8_t operator () (char c) const {return rank_[(uint8_t)c];}
+
+private:
+    uint8_t rank_[256];
+};
+
 //The main MovieMatch class
-class MovieMatch
+//N is the vertex id type; it sets the width of every per-vertex and per-edge array
+template < typename N = uint32_t >
+class BasicMovieMatch
 {
 public:
     
     //terminology support
-    typedef size_t                              Vertex;
+    typedef N                                   Vertex;
     typedef fsu::String                         Name;
-    typedef fsu::ALUGraph<Vertex>               Graph;
+    typedef fsu::CSRGraph<Vertex>               Graph;
     typedef fsu::BFSurvey<Graph>                BFS;
-    typedef hashclass::KISS<Name>               Hash;
+    typedef fsu::ShortestPaths<Graph>           SP; //all shortest paths over bfs_
+    typedef hashclass::Wy<Name>                 Hash;
     typedef fsu::HashTable<Name,Vertex,Hash>    AA; //associative array
+    typedef fsu::PerfectHash<Name,Vertex,Hash>  FrozenAA; //the same map, frozen by FreezeNames
     typedef fsu::Vector<Name>                   Vector; //vector of strings
     typedef fsu::List<Vertex>                   List; //list of vertices
+    typedef fsu::Vector<Vertex>                 VrtxVector; //vector of vertices
+    typedef fsu::Pair<Vertex,Vertex>            VrtxPair; //pair of actors for batch queries
+    typedef fsu::Closeness<Vertex>              Centrality; //actor with its total and average KB number
+    typedef fsu::Components<Vertex>             Components; //connected components, labeled at Load
+    typedef fsu::Landmarks<Graph>               Oracle; //landmark distance tables for actor-to-actor queries
+    typedef fsu::LabelIndex<Graph>              Labels; //pruned landmark labeling, exact pair distances
+    typedef fsu::Betweenness<Vertex>            Bridge; //actor or movie with its share of actor-to-actor shortest paths
     
-            MovieMatch ();          //default constructor
+            BasicMovieMatch ();     //default constructor
     bool    Load    (const char * filename);
+    void    Reorder (fsu::VertexOrder order);   //renumber vertices for locality; call between Load and Init
     bool    Init    (const char * actor);
-    void    Shuffle ();
+    void    Shuffle ();                 //later proofs are random shortest paths; the graph is not touched
+    void    Shuffle (uint64_t seed);    //same, restarting the random sequence at seed
     long    MovieDistance (const char * actor);
+    long    MovieDistance (const char * actor, List & path) const; //reentrant version for concurrent readers
     void    ShowPath (std::ostream & os) const;
-    void    ShowStar (Name name, std::ostream & os) const;
-    void    Hint (Name name, std::ostream & os, size_t size) const;
+    void    ShowPath (const List & path, std::ostream & os) const;
+    unsigned long long PathCount (const char * actor);  //number of shortest paths to base; 0 if unreachable
+    size_t  AllPaths (const char * actor, size_t k, fsu::Vector<List> & paths) const; //first k shortest paths
+    //neighbors by name, from position offset; limit = 0 shows all the rest
+    void    ShowStar (Name name, std::ostream & os, size_t offset = 0, size_t limit = 0) const;
+    void    Hint (Name name, std::ostream & os, size_t size = 6) const;
     void    Dump (std::ostream & os) const;
+    void    ComponentReport (std::ostream & os) const; //component size distribution, for checking the data
+    void    Statistics (std::ostream & os, bool json = 0) const; //KB number histogram, average, unreachable count
+    //the k actors with the lowest average KB number over the largest component; threads = 0 uses every core
+    void    CentralActors (size_t k, fsu::Vector<Centrality> & top, size_t threads = 0) const;
+    //the k actors or movies the most actor-to-actor shortest paths pass through (Brandes);
+    //samples = 0 is exact, otherwise estimated from that many random source actors
+    void    Bridges (size_t k, fsu::Vector<Bridge> & top, size_t samples = 0, uint64_t seed = 0, size_t threads = 0) const;
+    //actor-to-actor KB numbers without re-running the survey; -3 / -2 / -1 as MovieDistance
+    void    BuildOracle (size_t landmarks = 16, bool central = 0); //landmarks by degree, or the most central actors
+    bool    SaveOracle  (const char * filename) const;
+    bool    LoadOracle  (const char * filename); //0 if missing or made for another database / vertex order
+    long    ActorDistance (const char * actor1, const char * actor2);   //exact; label merge once BuildLabels has run
+    long    ActorDistance (const char * actor1, const char * actor2, long & upper) const; //O(landmarks) bounds; returns the lower
+    bool    BuildLabels (); //exact label index; see BuildTime() and ByteSize() of GetLabels()
+    bool    SaveLabels  (const char * filename) const;
+    bool    LoadLabels  (const char * filename, bool map = 1); //map = 1 maps the file read-only where possible
+    //the name dictionary, frozen into a minimal perfect hash after Load; vrtx_ is released
+    bool    FreezeNames ();
+    bool    SaveNames   (const char * filename) const;
+    bool    LoadNames   (const char * filename); //0 if missing or made for another database / vertex order
+    bool    Frozen      () const {return !frozen_.Empty();}
+    //largest finite KB number between two actors of the largest component, realized by actor1 and actor2
+    size_t  Diameter (Vertex & actor1, Vertex & actor2, size_t & sweeps) const;
+    
+    //movies both actors appeared in, ascending by vertex; returns the count, or -3 / -1 as MovieDistance
+    long    SharedMovies (const char * actor1, const char * actor2, VrtxVector & movies) const;
+    size_t  SharedMovies (Vertex actor1, Vertex actor2, VrtxVector & movies) const;
+    //batch: movies shared by pairs[k] are movies[offset[k]] ... movies[offset[k+1] - 1]
+    void    SharedMovies (const fsu::Vector<VrtxPair> & pairs, fsu::Vector<size_t> & offset, VrtxVector & movies) const;
+    
+    bool            Lookup      (const Name & name, Vertex & v) const {return Find(name, v);}
+    const Name &    NameOf      (Vertex v) const {return name_[v];}
+    const Graph &   GetGraph    () const {return g_;}
+    const BFS &     GetSurvey   () const {return bfs_;}
+    const Components & GetComponents () const {return comp_;}
+    const Labels &  GetLabels   () const {return labels_;}
+    const FrozenAA & GetFrozenNames () const {return frozen_;}
+    size_t          ComponentOf (Vertex v) const {return comp_.Component(v);}
+    size_t          ComponentSize (Vertex v) const {return comp_.SizeOf(v);}
+    bool            Connected   (Vertex v, Vertex w) const {return comp_.Same(v, w);}
     
 private:
     
     static void Line (std::istream & is, Vector & movie);  //helper read function
-    bool isMovie (Vertex v);                        //takes a vertex and determines if it is a movie
+    bool isMovie (Vertex v) const;                  //takes a vertex and determines if it is a movie
+    
+    //predicate form of !isMovie for the generic graph algorithms
+    class IsActor
+    {
+    public:
+        explicit IsActor (const BasicMovieMatch & mm) : mm_(mm) {}
+        bool operator () (Vertex v) const {return !mm_.isMovie(v);}
+    private:
+        const BasicMovieMatch & mm_;
+    };
+    
+    //orders vertices by name, as CaseInsensitiveLessThan orders names
+    class ByName
+    {
+    public:
+        explicit ByName (const Vector & name) : name_(name) {}
+        bool operator () (Vertex a, Vertex b) {return less_(name_[a], name_[b]);}
+    private:
+        const Vector &          name_;
+        CaseInsensitiveLessThan less_;
+    };
+    
+    bool Find (const Name & name, Vertex & v) const; //vertex of name, through frozen_ once it is built
+    
+    const Vertex * StarOrder (Vertex v) const; //neighbors of hub v by name, 0 if v is not a hub
+    void BuildStars (); //sorts the neighbors of every hub; called whenever g_ or name_ changes
+    
+    BasicMovieMatch (const BasicMovieMatch &);      //bfs_ refers to g_, so copies are disallowed
+    BasicMovieMatch & operator = (const BasicMovieMatch &);
     
     Graph   g_; //the bipartite graph connecting actors with movies
     Vector  name_; //the vector mapping vertex numbers to names
     Vector  hint_; //the hint vector used
+    fsu::Vector<char> movie_; //movie_[v] = 1 iff v is a movie (first name on its line)
     AA      vrtx_; //the associatve array mappint names to vertex numbers
+    FrozenAA frozen_; //vrtx_ as a minimal perfect hash; once built, vrtx_ is empty
+    Components comp_; //component id and size of every vertex
+    Oracle  oracle_; //landmark distances, built on request
+    Labels  labels_; //2-hop labels, built on request
     BFS     bfs_; //the breadth first survey
+    SP      sp_; //path counts, memoized per survey
+    fsu::Random_uint64_t random_; //drives Shuffle; seeded, so runs are repeatable
+    bool    shuffled_; //1 = MovieDistance draws a random shortest path instead of the BFS tree path
     
     Name    baseActor_; //holds the base actor's name
+    Vertex  base_; //the base actor's vertex
     List    path_; //holds the path from specified vertex to base
     
-}; //end class MovieMatch
+    //hub orders, read-only between Load/Reorder calls so const queries may share them:
+    //starOrder_[starBeg_[k], starBeg_[k+1]) = neighbors of starHub_[k] by name; starHub_ ascending
+    VrtxVector              starHub_;
+    fsu::Vector<size_t>     starBeg_;
+    VrtxVector              starOrder_;
+    
+}; //end class BasicMovieMatch
+
+//the 32-bit id version is the one clients normally use
+typedef BasicMovieMatch<>   MovieMatch;
 
 //default constructor - only initial object is created
-MovieMatch::MovieMatch() : g_(), name_(), hint_(), vrtx_(), bfs_(g_), baseActor_()
+template < typename N >
+BasicMovieMatch<N>::BasicMovieMatch() : g_(), name_(), hint_(), movie_(), vrtx_(), frozen_(), comp_(), oracle_(g_), labels_(g_), bfs_(g_), sp_(g_, bfs_), random_(0), shuffled_(0), baseActor_(), base_(0), starHub_(), starBeg_(), starOrder_()
 {}
 
-bool MovieMatch::Load (const char * filename)
+template < typename N >
+bool BasicMovieMatch<N>::Load (const char * filename)
 {
     std::cout << " Loading database " << filename << " (first read) ...";
     
@@ -113,7 +270,9 @@ bool MovieMatch::Load (const char * filename)
     bool isThere = 0;                   //Used to test presence in AA
     size_t movieCount = 0;
     size_t actorCount = 0;
+    size_t edgeCount = 0;
     size_t numBuckets = 100;            //used to optimize hash table load
+    const size_t maxId = std::numeric_limits<Vertex>::max(); //largest value a Vertex can hold
     
     std::ifstream inFile(filename, std::ios::in);
     if (!inFile)
@@ -126,7 +285,10 @@ bool MovieMatch::Load (const char * filename)
     {
         Line(inFile, inFileVector); //reads line with movie and actor information
         if (inFileVector.Size() > 0) //if it's not a blank line
+        {
             ++movieCount; //increment movie count (each line is a movie)
+            edgeCount += inFileVector.Size() - 1;
+        }
         
         //check to see if vertex is already in graph
         //loop through vector and attempt to insert names if they don't already exist
@@ -135,22 +297,42 @@ bool MovieMatch::Load (const char * filename)
             isThere = vrtx_.Retrieve(inFileVector[i],dummyVertexNum); //checks presence of vertex name
             if (!isThere) //if vertex doesn't already exist
             {
+                //the survey uses |V| as its null vertex, so |V| itself must fit in a Vertex
+                if ((size_t)vertexNum == maxId)
+                {
+                    std::cerr << "\n ** Load: " << filename << " has too many names for "
+                              << 8 * sizeof(Vertex) << "-bit vertex ids\n";
+                    return 0;
+                }
                 vrtx_[inFileVector[i]] = vertexNum; //adds name to AA with specified vertex number
                 name_.PushBack(inFileVector[i]);    //adds name to vector
                 hint_.PushBack(inFileVector[i]);    //similar to name, but will be sorted in Init()
+                movie_.PushBack(i == 0);            //the first name on a line is the movie
                 ++actorCount;
                 ++vertexNum; //increments vertex number
             }
+            else if (i == 0)
+            {
+                movie_[dummyVertexNum] = 1; //listed as a cast member before its own line
+            }
         }
         
         //HashTable optimization Note: "actorCount" is number of elements inserted into symbol tables
         if (actorCount > (2 * numBuckets))
         {
-            numBuckets *= 4; //double size of hash table
+            numBuckets = fsu::GrowthPrime(4 * numBuckets); //quadruple size of hash table; already prime, so no search
             vrtx_.Rehash(numBuckets);
         }
     }
     
+    //the survey stores 1 + |E| as its infinite distance
+    if (edgeCount >= maxId)
+    {
+        std::cerr << "\n ** Load: " << filename << " has too many credits for "
+                  << 8 * sizeof(Vertex) << "-bit vertex ids\n";
+        return 0;
+    }
+    
     //final optimization of hash table
     vrtx_.Rehash(actorCount);
     
@@ -163,7 +345,7 @@ bool MovieMatch::Load (const char * filename)
     
     std::cout << "(second read) ... ";
     
-    g_.SetVrtxSize(vrtx_.Size()); //sets number of graph vertices in the HashTable
+    fsu::ALUGraph<Vertex> al((Vertex)vrtx_.Size()); //lists grow while reading; frozen into g_ afterwards
     
     while (!(inFile.eof()))
     {
@@ -171,11 +353,14 @@ bool MovieMatch::Load (const char * filename)
         for (size_t i = 1; i < inFileVector.Size(); ++i)
         {
             //adds edge from movie in position 0 to actor in position i
-            g_.AddEdge(vrtx_[inFileVector[0]], vrtx_[inFileVector[i]]);
+            al.AddEdge(vrtx_[inFileVector[0]], vrtx_[inFileVector[i]]);
         }
     }
     
     inFile.close();
+    g_.Build(al); //sorted adjacency arrays
+    BuildStars();
+    comp_.Build(g_);
     
     std::cout << "done.\n ";
     std::cout << movieCount << " movies and " << actorCount << " actors read from " << filename << "\n";
@@ -184,15 +369,62 @@ bool MovieMatch::Load (const char * filename)
 }
 
 
+//Renumbers every vertex by the requested ordering: name_, the values in vrtx_ (or the
+//frozen table, rebuilt) and the adjacency lists are permuted consistently.  A survey in progress is re-run.
+template < typename N >
+void BasicMovieMatch<N>::Reorder (fsu::VertexOrder order)
+{
+    if (order == fsu::loadOrder)
+        return; //ids are already in order of first appearance
+    
+    fsu::Vector<Vertex> perm; //perm[old] = new
+    fsu::ComputeOrder(g_, order, perm);
+    
+    Vector name(name_.Size());
+    fsu::Vector<char> movie(movie_.Size());
+    for (Vertex v = 0; v < name_.Size(); ++v)
+    {
+        name[perm[v]] = name_[v];
+        movie[perm[v]] = movie_[v];
+        if (frozen_.Empty())
+            vrtx_[name_[v]] = perm[v];
+    }
+    name_.Swap(name);
+    movie_.Swap(movie);
+    if (!frozen_.Empty())
+        FreezeNames(); //same names, so the build succeeds again
+    g_.Relabel(perm);
+    BuildStars(); //name_ is already relabeled
+    comp_.Build(g_); //ids are relabeled by size, so the result does not depend on the order
+    oracle_.Relabel(perm);
+    labels_.Relabel(perm);
+    
+    path_.Clear(); //old ids are meaningless now
+    if (baseActor_.Size() > 0)
+    {
+        Find(baseActor_, base_);
+        bfs_.Reset();
+        bfs_.Search(base_);
+    }
+    sp_.Reset();
+}
+
+
 //Initializes the BFS object with the actor as the start point
-bool MovieMatch::Init (const char * actor)
+template < typename N >
+bool BasicMovieMatch<N>::Init (const char * actor)
 {
     CaseInsensitiveLessThan pred_; //declares predicate object
-    fsu::g_heap_sort(hint_.Begin(),hint_.End(), pred_); //sorts the hint array
+    CaseInsensitiveRank rank_;
+    size_t sorted = 1;
+    while (sorted < hint_.Size() && !pred_(hint_[sorted], hint_[sorted-1]))
+        ++sorted;
+    if (sorted < hint_.Size()) //sorts the hint array once per Load, on every core; each name moves once
+        fsu::g_radix_sort(hint_.Begin(), hint_.End(), rank_, 0);
     
     //determine if the actor is in the database
     Vertex v;
-    bool isHere = vrtx_.Retrieve(actor,v); //if successful, vertex number will be in v
+    bool isHere = Find(actor,v); //if successful, vertex number will be in v
 
     if (!isHere)
     {
@@ -207,33 +439,56 @@ bool MovieMatch::Init (const char * actor)
     else
     {
         baseActor_ = actor; //sets base actor in MM object
+        base_ = v;
         bfs_.Reset(); //resets BFS object with up-do-date graph information
         bfs_.Search(v); //search graph with vertex v as base
+        sp_.Reset();
 
         return 1;
     }
 }
 
 
-void MovieMatch::Shuffle()
+//Selects uniformly among all shortest paths by walking predecessors weighted by
+//path counts (see spaths.h); costs O(1) here and O(path) per query once counts are known
+template < typename N >
+void BasicMovieMatch<N>::Shuffle()
 {
-    g_.Shuffle();
-    bfs_.Reset();
-    bfs_.Search(vrtx_[baseActor_]);
+    shuffled_ = 1;
 }
 
 
-long MovieMatch::MovieDistance(const char * actor)
+template < typename N >
+void BasicMovieMatch<N>::Shuffle(uint64_t seed)
+{
+    random_.Seed(seed);
+    shuffled_ = 1;
+}
+
+
+template < typename N >
+long BasicMovieMatch<N>::MovieDistance(const char * actor)
+{
+    long movieDistance = MovieDistance(actor, path_); //path_ is kept for ShowPath(os)
+    if (shuffled_ && movieDistance >= 0)
+        sp_.RandomPath(path_.Front(), random_, path_);
+    return movieDistance;
+}
+
+
+//const version writes the path into the caller's list, so many readers can share one MovieMatch
+template < typename N >
+long BasicMovieMatch<N>::MovieDistance(const char * actor, List & path) const
 {
     //-3, -2, or -1 or actual movie distance
     Vertex v;
-    bool isHere = vrtx_.Retrieve(actor, v); //if successful, vertex number will be in v
+    bool isHere = Find(actor, v); //if successful, vertex number will be in v
 
     if (!isHere)
     {
         return -3; //name is not in database
     }
-    else if (bfs_.Color()[v] != 'b') //if the actor is unreachable from base
+    else if (!comp_.Same(v, base_)) //if the actor is unreachable from base; no survey lookup needed
     {
         return -2;
     }
@@ -245,13 +500,13 @@ long MovieMatch::MovieDistance(const char * actor)
     {
         long movieDistance = bfs_.Distance()[v] / 2; //computed directly from bfs_'s distance vector
 
-        path_.Clear(); //clear any pre-existing path
-        path_.PushBack(v); //push actor vertex onto path_
+        path.Clear(); //clear any pre-existing path
+        path.PushBack(v); //push actor vertex onto path
         
         //note: the base actor's parent will be null_
         while (bfs_.Parent()[v] != bfs_.NullVertex())
         {
-            path_.PushBack(bfs_.Parent()[v]);
+            path.PushBack(bfs_.Parent()[v]);
             v = bfs_.Parent()[v];
         }
 
@@ -260,15 +515,44 @@ long MovieMatch::MovieDistance(const char * actor)
 }
 
 
-void MovieMatch::ShowPath(std::ostream & os) const
+template < typename N >
+unsigned long long BasicMovieMatch<N>::PathCount(const char * actor)
+{
+    Vertex v;
+    if (!Find(actor, v) || !comp_.Same(v, base_))
+        return 0; //name is not in database, or unreachable
+    return sp_.PathCount(v);
+}
+
+
+//paths are listed actor first, base last, as MovieDistance leaves them
+template < typename N >
+size_t BasicMovieMatch<N>::AllPaths(const char * actor, size_t k, fsu::Vector<List> & paths) const
+{
+    Vertex v;
+    paths.Clear();
+    if (!Find(actor, v))
+        return 0; //name is not in database
+    return sp_.Paths(v, k, paths);
+}
+
+
+template < typename N >
+void BasicMovieMatch<N>::ShowPath(std::ostream & os) const
+{
+    ShowPath(path_, os);
+}
+
+
+template < typename N >
+void BasicMovieMatch<N>::ShowPath(const List & path, std::ostream & os) const
 {
     size_t counter = 0;
     
-    List::ConstIterator i;
-    i = path_.Begin();
+    typename List::ConstIterator i;
     
     os << "\n";
-    for (i = path_.Begin(); i != path_.End(); ++i)
+    for (i = path.Begin(); i != path.End(); ++i)
     {
         if ((counter % 2) == 1)
             os << "   | ";
@@ -281,34 +565,89 @@ void MovieMatch::ShowPath(std::ostream & os) const
 }
 
 
-void MovieMatch::ShowStar(Name name, std::ostream & os) const
+template < typename N >
+void BasicMovieMatch<N>::ShowStar(Name name, std::ostream & os, size_t offset, size_t limit) const
 {
-    Graph::AdjIterator i;
-    Vertex v = vrtx_[name]; //determines vertex number of the star name; note: protected in const environment
-    
-    Vector sortedStar;
-    for (i = g_.Begin(v); i != g_.End(v); ++i)
+    Vertex v;
+    if (!Find(name, v)) //determines vertex number of the star name
     {
-        sortedStar.PushBack(name_[*i]); //push names onto list
+        std::cerr << " ** ShowStar: " << name << " is not in the database\n";
+        return;
     }
-    
-    CaseInsensitiveLessThan pred_;
-    fsu::g_heap_sort(sortedStar.Begin(), sortedStar.End(), pred_); //sorts the vector
+    size_t degree = g_.OutDegree(v);
+    if (offset > degree)
+        offset = degree;
+    size_t end = (limit == 0 || degree - offset < limit) ? degree : offset + limit;
     
     os << "\n ";
     os << name << "\n";
     
-    for (Vector::ConstIterator i = sortedStar.Begin(); i != sortedStar.End(); ++i)
+    if (degree >= starCacheDegree) //hub: sorted once, then every page is a slice
+    {
+        const Vertex * order = StarOrder(v);
+        for (size_t k = offset; k < end; ++k)
+        {
+            os << "   | " << name_[order[k]] << "\n";
+        }
+    }
+    else //only the requested page is put in order
     {
-        os << "   | " << *i << "\n";
+        VrtxVector star(degree);
+        fsu::g_copy(g_.Begin(v), g_.End(v), star.Begin());
+        ByName byName(name_);
+        if (offset < degree)
+            fsu::g_nth_element(star.Begin(), star.Begin() + offset, star.End(), byName);
+        fsu::g_partial_sort(star.Begin() + offset, star.Begin() + end, star.End(), byName);
+        for (size_t k = offset; k < end; ++k)
+        {
+            os << "   | " << name_[star[k]] << "\n";
+        }
     }
     
     os << "\n\n";
 }
 
+template < typename N >
+const typename BasicMovieMatch<N>::Vertex * BasicMovieMatch<N>::StarOrder (Vertex v) const
+{
+    const Vertex * hub = fsu::g_lower_bound(starHub_.Begin(), starHub_.End(), v);
+    if (hub == starHub_.End() || *hub != v)
+        return 0;
+    return starOrder_.Begin() + starBeg_.Begin()[hub - starHub_.Begin()];
+}
+
+template < typename N >
+void BasicMovieMatch<N>::BuildStars ()
+{
+    starHub_.Clear();
+    starBeg_.Clear();
+    size_t total = 0;
+    for (Vertex v = 0; v < (Vertex)g_.VrtxSize(); ++v)
+    {
+        if (g_.OutDegree(v) >= starCacheDegree)
+        {
+            starHub_.PushBack(v);
+            starBeg_.PushBack(total);
+            total += g_.OutDegree(v);
+        }
+    }
+    starBeg_.PushBack(total);
+    
+    starOrder_.SetSize(total);
+    ByName byName(name_);
+    for (size_t k = 0; k < starHub_.Size(); ++k)
+    {
+        Vertex * beg = starOrder_.Begin() + starBeg_[k];
+        Vertex * end = starOrder_.Begin() + starBeg_[k+1];
+        fsu::g_copy(g_.Begin(starHub_[k]), g_.End(starHub_[k]), beg);
+        fsu::g_sort(beg, end, byName);
+    }
+}
 
 
-void MovieMatch::Hint (Name name, std::ostream & os, size_t size = 6) const
+
+template < typename N >
+void BasicMovieMatch<N>::Hint (Name name, std::ostream & os, size_t size) const
 {
     CaseInsensitiveLessThan pred_;
     size_t truncSize = size;
@@ -340,12 +679,12 @@ void MovieMatch::Hint (Name name, std::ostream & os, size_t size = 6) const
     trunczz.Wrap(charStringZ);
     
     
-    Vector::ConstIterator fullHintBegin = hint_.Begin();
-    Vector::ConstIterator fullHintEnd   = hint_.End();
+    typename Vector::ConstIterator fullHintBegin = hint_.Begin();
+    typename Vector::ConstIterator fullHintEnd   = hint_.End();
     
     
-    Vector::ConstIterator hintBegin = fsu::g_lower_bound(fullHintBegin, fullHintEnd, trunc, pred_);
-    Vector::ConstIterator hintEnd   = fsu::g_upper_bound(fullHintBegin, fullHintEnd, trunczz, pred_);
+    typename Vector::ConstIterator hintBegin = fsu::g_lower_bound(fullHintBegin, fullHintEnd, trunc, pred_);
+    typename Vector::ConstIterator hintEnd   = fsu::g_upper_bound(fullHintBegin, fullHintEnd, trunczz, pred_);
 
     
     //move hintBegin iterator back by 2, if possible
@@ -364,7 +703,7 @@ void MovieMatch::Hint (Name name, std::ostream & os, size_t size = 6) const
     }
     
     
-    Vector::ConstIterator h;
+    typename Vector::ConstIterator h;
     for (h = hintBegin; h != hintEnd; ++h)
     {
         std::cout << *h << "\n";
@@ -372,20 +711,350 @@ void MovieMatch::Hint (Name name, std::ostream & os, size_t size = 6) const
     
 }
 
-void MovieMatch::Dump (std::ostream & os) const
+//actors are adjacent only to movies, so the shared movies are the common neighbors
+template < typename N >
+long BasicMovieMatch<N>::SharedMovies (const char * actor1, const char * actor2, VrtxVector & movies) const
+{
+    Vertex v, w;
+    movies.Clear();
+    if (!Find(actor1, v) || !Find(actor2, w))
+        return -3; //name is not in database
+    if (isMovie(v) || isMovie(w))
+        return -1;
+    return (long)SharedMovies(v, w, movies);
+}
+
+
+template < typename N >
+size_t BasicMovieMatch<N>::SharedMovies (Vertex actor1, Vertex actor2, VrtxVector & movies) const
+{
+    g_.Intersect(actor1, actor2, movies);
+    return movies.Size();
+}
+
+
+template < typename N >
+void BasicMovieMatch<N>::SharedMovies (const fsu::Vector<VrtxPair> & pairs, fsu::Vector<size_t> & offset, VrtxVector & movies) const
+{
+    //one pass sizes the output for the worst case, so the loop below never reallocates
+    size_t bound = 0;
+    for (size_t k = 0; k < pairs.Size(); ++k)
+    {
+        size_t d1 = g_.OutDegree(pairs[k].first_), d2 = g_.OutDegree(pairs[k].second_);
+        bound += (d1 < d2 ? d1 : d2);
+    }
+    movies.SetSize(bound);
+    offset.SetSize(pairs.Size() + 1);
+    
+    size_t end = 0;
+    for (size_t k = 0; k < pairs.Size(); ++k)
+    {
+        offset[k] = end;
+        end += g_.Intersect(pairs[k].first_, pairs[k].second_, movies.Begin() + end);
+    }
+    offset[pairs.Size()] = end;
+    movies.SetSize(end);
+}
+
+
+//One pass over the survey's distance vector.  The graph is bipartite and the base is
+//an actor, so reached vertices at even distance are exactly the reached actors; only
+//the unreached vertices need the movie test.
+template < typename N >
+void BasicMovieMatch<N>::Statistics (std::ostream & os, bool json) const
+{
+    const fsu::Vector<Vertex> & distance = bfs_.Distance();
+    const Vertex infinity = (Vertex)bfs_.InfiniteDistance();
+    size_t n = distance.Size();
+    
+    //histogram by raw distance; no branches on the vertex type in the hot loop
+    fsu::Vector<size_t> count(1 + n, 0);
+    size_t maxDistance = 0, unreached = 0;
+    for (size_t x = 0; x < n; ++x)
+    {
+        Vertex d = distance[x];
+        if (d == infinity)
+            ++unreached;
+        else
+        {
+            ++count[d];
+            if (d > maxDistance) maxDistance = d;
+        }
+    }
+    size_t unreachableActors = 0;
+    if (unreached > 0)
+    {
+        for (Vertex x = 0; x < n; ++x)
+        {
+            if (distance[x] == infinity && !isMovie(x))
+                ++unreachableActors;
+        }
+    }
+    
+    size_t reachable = 0, total = 0;
+    for (size_t d = 0; d <= maxDistance; d += 2)
+    {
+        reachable += count[d];
+        total += count[d] * (d / 2);
+    }
+    double average = reachable > 0 ? (double)total / reachable : 0.0;
+    
+    std::ios_base::fmtflags flags = os.flags(); //the average is always written as fixed, 3 places
+    std::streamsize precision = os.precision(3);
+    os.setf(std::ios_base::fixed, std::ios_base::floatfield);
+    if (json)
+    {
+        os << "{\"base\": \"";
+        for (size_t i = 0; i < baseActor_.Size(); ++i)
+        {
+            if (baseActor_[i] == '"' || baseActor_[i] == '\\')
+                os << '\\';
+            os << baseActor_[i];
+        }
+        os << "\", \"histogram\": [";
+        for (size_t d = 0; d <= maxDistance; d += 2)
+            os << (d > 0 ? ", " : "") << count[d];
+        os << "], \"reachable\": " << reachable
+           << ", \"average\": " << average
+           << ", \"unreachable\": " << unreachableActors << "}\n";
+    }
+    else
+    {
+        os << " KB number statistics for " << baseActor_ << '\n'
+           << "   KB      actors\n";
+        for (size_t d = 0; d <= maxDistance; d += 2)
+        {
+            os << "   ";
+            os.width(2);
+            os << d / 2 << "  ";
+            os.width(10);
+            os << count[d] << '\n';
+        }
+        os << " reachable actors:   " << reachable << '\n'
+           << " average KB number:  " << average << '\n'
+           << " unreachable actors: " << unreachableActors << '\n';
+    }
+    os.flags(flags);
+    os.precision(precision);
+}
+
+//stride 2: from an actor, the even-distance vertices are the actors, at twice their KB number
+template < typename N >
+void BasicMovieMatch<N>::CentralActors (size_t k, fsu::Vector<Centrality> & top, size_t threads) const
+{
+    IsActor isActor(*this);
+    fsu::TopCloseness(g_, k, isActor, top, 2, threads);
+}
+
+//every actor is a path end; movies and actors are both scored
+template < typename N >
+void BasicMovieMatch<N>::Bridges (size_t k, fsu::Vector<Bridge> & top, size_t samples, uint64_t seed, size_t threads) const
+{
+    IsActor isActor(*this);
+    fsu::TopBetweenness(g_, k, isActor, top, samples, seed, threads);
+}
+
+template < typename N >
+void BasicMovieMatch<N>::BuildOracle (size_t landmarks, bool central)
+{
+    if (central)
+    {
+        fsu::Vector<Centrality> top;
+        CentralActors(landmarks, top);
+        VrtxVector chosen(top.Size());
+        for (size_t l = 0; l < top.Size(); ++l)
+            chosen[l] = top[l].vertex_;
+        oracle_.Build(chosen);
+    }
+    else
+    {
+        IsActor isActor(*this);
+        oracle_.Choose(landmarks, isActor);
+    }
+}
+
+
+template < typename N >
+bool BasicMovieMatch<N>::SaveOracle (const char * filename) const
+{
+    return oracle_.Save(filename);
+}
+
+
+template < typename N >
+bool BasicMovieMatch<N>::LoadOracle (const char * filename)
+{
+    return oracle_.Load(filename);
+}
+
+
+template < typename N >
+bool BasicMovieMatch<N>::Find (const Name & name, Vertex & v) const
+{
+    if (frozen_.Empty())
+        return vrtx_.Retrieve(name, v);
+    return frozen_.Retrieve(name, v) && name_[v] == name; //other names land on some vertex too
+}
+
+
+template < typename N >
+bool BasicMovieMatch<N>::FreezeNames ()
+{
+    VrtxVector vertex(name_.Size());
+    for (Vertex v = 0; v < name_.Size(); ++v)
+        vertex[v] = v;
+    if (!frozen_.Build(name_, vertex))
+        return 0; //vrtx_ is still there
+    vrtx_.Clear();
+    vrtx_.Rehash(); //down to the minimum bucket count
+    return 1;
+}
+
+
+template < typename N >
+bool BasicMovieMatch<N>::SaveNames (const char * filename) const
+{
+    if (frozen_.Empty())
+    {
+        std::cerr << " ** SaveNames: the names are not frozen\n";
+        return 0;
+    }
+    return frozen_.Save(filename);
+}
+
+
+//the file holds no names, so it is checked by looking up every name: each must come back as its own vertex
+template < typename N >
+bool BasicMovieMatch<N>::LoadNames (const char * filename)
+{
+    FrozenAA table;
+    if (!table.Load(filename))
+        return 0;
+    bool valid = table.Size() == name_.Size();
+    Vertex w;
+    for (Vertex v = 0; valid && v < name_.Size(); ++v)
+        valid = table.Retrieve(name_[v], w) && w == v;
+    if (!valid)
+    {
+        std::cerr << " ** LoadNames: " << filename << " was built for a different database or vertex order\n";
+        return 0;
+    }
+    frozen_ = table;
+    vrtx_.Clear();
+    vrtx_.Rehash();
+    return 1;
+}
+
+
+template < typename N >
+bool BasicMovieMatch<N>::BuildLabels ()
+{
+    return labels_.Build();
+}
+
+
+template < typename N >
+bool BasicMovieMatch<N>::SaveLabels (const char * filename) const
+{
+    return labels_.Save(filename);
+}
+
+
+template < typename N >
+bool BasicMovieMatch<N>::LoadLabels (const char * filename, bool map)
+{
+    return map ? labels_.Map(filename) : labels_.Load(filename);
+}
+
+
+//distances between actors are even: two edges per movie
+template < typename N >
+long BasicMovieMatch<N>::ActorDistance (const char * actor1, const char * actor2)
+{
+    Vertex v, w;
+    if (!Find(actor1, v) || !Find(actor2, w))
+        return -3; //name is not in database
+    if (!comp_.Same(v, w))
+        return -2;
+    if (isMovie(v) || isMovie(w))
+        return -1;
+    if (labels_.Built())
+        return (long)(labels_.Distance(v, w) / 2);
+    return (long)(oracle_.Distance(v, w) / 2);
+}
+
+
+template < typename N >
+long BasicMovieMatch<N>::ActorDistance (const char * actor1, const char * actor2, long & upper) const
+{
+    Vertex v, w;
+    upper = -3;
+    if (!Find(actor1, v) || !Find(actor2, w))
+        return -3; //name is not in database
+    upper = -2;
+    if (!comp_.Same(v, w))
+        return -2;
+    upper = -1;
+    if (isMovie(v) || isMovie(w))
+        return -1;
+    size_t high = oracle_.Upper(v, w);
+    upper = (high == oracle_.InfiniteDistance()) ? std::numeric_limits<long>::max() : (long)(high / 2);
+    return (long)((oracle_.Lower(v, w) + 1) / 2);
+}
+
+//iFUB over actor endpoints (ecc.h), started from the largest-degree actor
+template < typename N >
+size_t BasicMovieMatch<N>::Diameter (Vertex & actor1, Vertex & actor2, size_t & sweeps) const
+{
+    IsActor isActor(*this);
+    Vertex hub = (Vertex)g_.VrtxSize();
+    for (Vertex v = 0; v < g_.VrtxSize(); ++v)
+    {
+        if (!isMovie(v) && (hub == (Vertex)g_.VrtxSize() || g_.OutDegree(v) > g_.OutDegree(hub)))
+            hub = v;
+    }
+    sweeps = 0;
+    if (hub == (Vertex)g_.VrtxSize())
+        return 0; //no actors
+    fsu::Eccentricity<Graph,IsActor> ecc(g_, isActor);
+    size_t diameter = ecc.Diameter(hub, actor1, actor2);
+    sweeps = ecc.Sweeps();
+    return diameter / 2;
+}
+
+template < typename N >
+void BasicMovieMatch<N>::Dump (std::ostream & os) const
 {
     ShowAL(g_,os);
     WriteData(bfs_,os);
-    vrtx_.Dump(os);
+    if (frozen_.Empty())
+        vrtx_.Dump(os);
+    Vertex v = 0;
     for (size_t i = 0; i < name_.Size(); ++i)
     {
+        Find(name_[i], v);
         os << "name_[" << i << "] = " << name_[i] << '\t';
-        os << "vrtx_[" << name_[i] << "] = " << vrtx_[name_[i]] << '\n';
+        os << "vrtx_[" << name_[i] << "] = " << v << '\n';
     }
-    vrtx_.Analysis(std::cout);
+    if (frozen_.Empty())
+        vrtx_.Analysis(std::cout);
+    else
+        std::cout << " frozen names: " << frozen_.Size() << " keys, " << frozen_.Levels() << " levels, "
+                  << (double)frozen_.FunctionBits() / (frozen_.Size() ? frozen_.Size() : 1) << " bits/key\n";
 }
 
-void MovieMatch::Line (std::istream& is, fsu::Vector<Name>& movie)
+template < typename N >
+void BasicMovieMatch<N>::ComponentReport (std::ostream & os) const
+{
+    os << " Connected components:";
+    comp_.Distribution(os);
+    if (baseActor_.Size() > 0)
+        os << " " << baseActor_ << " is in component " << comp_.Component(base_)
+           << " (" << comp_.SizeOf(base_) << " vertices)\n";
+}
+
+template < typename N >
+void BasicMovieMatch<N>::Line (std::istream& is, fsu::Vector<Name>& movie)
 {
     movie.Clear();
     fsu::String line;
@@ -407,28 +1076,12 @@ void MovieMatch::Line (std::istream& is, fsu::Vector<Name>& movie)
     delete [] name_buffer;
 }
 
-bool MovieMatch::isMovie(Vertex v)
+//Recorded at Load: titles such as "Hero (1992 I)" do not end in a bare year, so the
+//name alone does not tell
+template < typename N >
+bool BasicMovieMatch<N>::isMovie(Vertex v) const
 {
-    fsu::String s(name_[v]); //instantiates string with name corresponding to vertex
-    size_t stringSize = s.Length(); //gets lengh of string
-    //determines if last part of string is a year
-    if (s[stringSize -1] != ')')
-    {
-        return 0; //not a movie
-    }
-    else if (   isdigit(s[stringSize-2]) &&
-                isdigit(s[stringSize-3]) &&
-                isdigit(s[stringSize-4]) &&
-                isdigit(s[stringSize-5]) &&
-                (s[stringSize-6] == '(')
-            )
-    {
-        return 1; //title ends in a year, is a movie
-    }
-    else
-    {
-        return 0; //not a movie
-    }
+    return movie_[v] != 0;
 }
 
 #endif /* MOVIEMATCH_H */
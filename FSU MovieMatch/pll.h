@@ -0,0 +1,470 @@
+/*
+    pll.h
+    Andrew J Wood
+    COP 4530
+
+    Defines and implements LabelIndex, an exact distance index built by
+    pruned landmark labeling (Akiba, Iwata and Yoshida), a 2-hop cover.
+
+    Every vertex v gets a label: a list of (hub, d(hub, v)) pairs, sorted by
+    hub.  The labels cover every pair: some hub on a shortest s-t path is in
+    both labels, so
+
+        d(s,t) = min over hubs h in both labels of d(h,s) + d(h,t)
+
+    and Distance(s,t) is one merge of two sorted arrays.
+
+    Build visits the vertices by decreasing degree and runs a BFS from each
+    in turn.  When the BFS from root r reaches u at depth d and the labels
+    built so far already give a distance <= d between r and u, u is pruned:
+    it gets no entry and is not expanded.  Hubs are stored as ranks in the
+    degree order, so entries are appended in sorted order and the big hubs
+    end up in nearly every label, which prunes the later searches early.
+
+    Leaves (degree 1 vertices whose neighbor, the anchor, has degree > 1)
+    are left out: no shortest path passes through a leaf, so they are never
+    hubs, and a leaf's distances are its anchor's plus one.  They get empty
+    labels and queries step to the anchor first.  In the movie database most
+    actors appear in a single movie, so this removes most of the vertices
+    from the build.
+
+    Storage is three flat arrays: offset (|V| + 1 entries), hub ranks and
+    one-byte distances.  Save writes them after a header (magic, version,
+    vertex id size, |V|, |E|, a fingerprint of the degree sequence, entry
+    count); Load reads a file back and Map maps it read-only where mmap is
+    available (Load elsewhere), so a large index is shared by the page cache
+    and opening it costs no reading.  Integers are in host byte order.
+
+    Distances must be below 255 (the index refuses to build otherwise).
+
+    Note that the code is self-documenting.
+ */
+
+#ifndef PLL_H
+#define PLL_H
+
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector.h>
+#include <vrtxorder.h>
+#include <timer.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#define PLL_MMAP
+#endif
+
+namespace fsu {
+
+    template < class G >
+    class LabelIndex
+    {
+    public:
+
+        typedef G                           Graph;
+        typedef typename Graph::Vertex      Vertex;
+        typedef typename Graph::AdjIterator AdjIterator;
+        typedef uint8_t                     Entry; //distance to a hub
+
+        static const Entry  unreached = 255;
+
+        explicit LabelIndex (const Graph & g);
+                 ~LabelIndex ();
+
+        bool    Build       (); //0 if some distance does not fit an Entry
+        void    Relabel     (const fsu::Vector<Vertex> & perm); //follows the graph's renumbering, perm[old] = new
+        void    Clear       ();
+
+        size_t  Distance    (Vertex s, Vertex t) const; //InfiniteDistance() if not connected; reentrant
+
+        bool    Built       () const {return offset_ != 0;}
+        size_t  Entries     () const {return Built() ? (size_t)offset_[g_.VrtxSize()] : 0;}
+        size_t  LabelSize   (Vertex v) const {return (size_t)(offset_[v + 1] - offset_[v]);}
+        size_t  ByteSize    () const {return (g_.VrtxSize() + 1) * sizeof(uint64_t) + Entries() * (sizeof(Vertex) + sizeof(Entry));}
+        bool    Leaf        (Vertex v) const {return g_.OutDegree(v) == 1 && g_.OutDegree(*g_.Begin(v)) > 1;}
+        const fsu::Instant & BuildTime () const {return buildTime_;}
+        bool    Mapped      () const {return map_ != 0;}
+        size_t  InfiniteDistance () const {return 1 + g_.EdgeSize();}
+
+        bool    Save        (const char * filename) const;
+        bool    Load        (const char * filename);
+        bool    Map         (const char * filename);
+
+    private:
+
+        LabelIndex              (const LabelIndex &); //g_ is a reference
+        LabelIndex & operator = (const LabelIndex &);
+
+        struct Header
+        {
+            char        magic_[4];
+            uint32_t    version_;
+            uint32_t    vertexSize_;
+            uint32_t    pad_;
+            uint64_t    vrtxSize_;
+            uint64_t    edgeSize_;
+            uint64_t    fingerprint_;
+            uint64_t    entries_;
+        };
+
+        uint64_t    Fingerprint () const; //FNV-1a over the degree sequence
+        bool        Check       (const Header & h, const char * filename) const;
+        void        Own         (); //points the arrays at the owned vectors
+        void        Unmap       ();
+
+        const Graph &           g_;
+        const uint64_t *        offset_;    //label of v is [offset_[v], offset_[v+1])
+        const Vertex *          hub_;       //hub ranks, ascending within a label
+        const Entry *           dist_;
+        fsu::Vector<uint64_t>   offsetStore_;
+        fsu::Vector<Vertex>     hubStore_;
+        fsu::Vector<Entry>      distStore_;
+        void *                  map_;       //the mapped file, if Map was used
+        size_t                  mapSize_;
+        fsu::Instant            buildTime_;
+
+    }; //end class LabelIndex
+
+
+    //----
+    //LabelIndex implementations
+    //----
+
+    template < class G >
+    const typename LabelIndex<G>::Entry LabelIndex<G>::unreached;
+
+    template < class G >
+    LabelIndex<G>::LabelIndex (const Graph & g)
+    :   g_(g), offset_(0), hub_(0), dist_(0), offsetStore_(), hubStore_(), distStore_(),
+        map_(0), mapSize_(0), buildTime_()
+    {}
+
+    template < class G >
+    LabelIndex<G>::~LabelIndex ()
+    {
+        Unmap();
+    }
+
+    template < class G >
+    void LabelIndex<G>::Own ()
+    {
+        offset_ = offsetStore_.Begin();
+        hub_ = hubStore_.Begin();
+        dist_ = distStore_.Begin();
+    }
+
+    template < class G >
+    bool LabelIndex<G>::Build ()
+    {
+        fsu::Timer timer;
+        timer.EventReset();
+        Clear();
+        size_t n = g_.VrtxSize();
+
+        fsu::Vector<Vertex> order;
+        SortByDegree(g_, order, 1);
+
+        //labels grow one hub at a time, in rank order
+        fsu::Vector< fsu::Vector<Vertex> > hub(n);
+        fsu::Vector< fsu::Vector<Entry> > dist(n);
+        fsu::Vector<Entry> rootDistStore(n, unreached);
+        fsu::Vector<Entry> depthStore(n, unreached);
+        fsu::Vector<Vertex> queueStore(n);
+        Entry * rootDist = rootDistStore.Begin();   //rootDist[rank] = d(root, hub of that rank)
+        Entry * depth = depthStore.Begin();         //BFS depth from the root; unreached = not visited
+        Vertex * queue = queueStore.Begin();
+        AdjIterator i;
+
+        for (size_t k = 0; k < n; ++k)
+        {
+            Vertex r = order[k];
+            if (Leaf(r))
+                continue;
+            for (size_t j = 0; j < hub[r].Size(); ++j)
+                rootDist[hub[r][j]] = dist[r][j];
+
+            size_t head = 0, tail = 0;
+            queue[tail++] = r;
+            depth[r] = 0;
+            while (head < tail)
+            {
+                Vertex u = queue[head++];
+                Entry du = depth[u];
+
+                //pruned if the labels so far already cover (r, u) within du; this scan is
+                //the bulk of the build, so it runs on raw pointers
+                const Vertex * h = hub[u].Begin();
+                const Entry * d = dist[u].Begin();
+                size_t m = hub[u].Size(), j = 0;
+                while (j < m && (size_t)rootDist[h[j]] + d[j] > du)
+                    ++j;
+                if (j < m)
+                    continue;
+
+                hub[u].PushBack((Vertex)k);
+                dist[u].PushBack(du);
+                for (i = g_.Begin(u); i != g_.End(u); ++i)
+                {
+                    if (depth[*i] == unreached && !Leaf(*i))
+                    {
+                        if (du + 1 >= unreached)
+                        {
+                            std::cerr << " ** LabelIndex::Build: distances of " << (size_t)unreached
+                                      << " or more do not fit the index\n";
+                            Clear();
+                            return 0;
+                        }
+                        depth[*i] = du + 1;
+                        queue[tail++] = *i;
+                    }
+                }
+            }
+
+            for (size_t j = 0; j < tail; ++j)
+                depth[queue[j]] = unreached;
+            for (size_t j = 0; j < hub[r].Size(); ++j)
+                rootDist[hub[r][j]] = unreached;
+        }
+
+        //flatten
+        offsetStore_.SetSize(n + 1);
+        offsetStore_[0] = 0;
+        for (size_t v = 0; v < n; ++v)
+            offsetStore_[v + 1] = offsetStore_[v] + hub[v].Size();
+        hubStore_.SetSize(offsetStore_[n]);
+        distStore_.SetSize(offsetStore_[n]);
+        for (size_t v = 0; v < n; ++v)
+        {
+            if (hub[v].Size() == 0) continue;
+            memcpy(hubStore_.Begin() + offsetStore_[v], hub[v].Begin(), hub[v].Size() * sizeof(Vertex));
+            memcpy(distStore_.Begin() + offsetStore_[v], dist[v].Begin(), dist[v].Size());
+        }
+        Own();
+        buildTime_ = timer.EventTime();
+        return 1;
+    }
+
+    template < class G >
+    size_t LabelIndex<G>::Distance (Vertex s, Vertex t) const
+    {
+        if (s == t)
+            return 0;
+        size_t extra = 0;
+        if (Leaf(s))
+        {
+            s = *g_.Begin(s);
+            ++extra;
+        }
+        if (Leaf(t))
+        {
+            t = *g_.Begin(t);
+            ++extra;
+        }
+        size_t best = InfiniteDistance();
+        if (s == t)
+            return extra; //a leaf and its anchor, or two leaves of one anchor
+        uint64_t i = offset_[s], iEnd = offset_[s + 1];
+        uint64_t j = offset_[t], jEnd = offset_[t + 1];
+        while (i < iEnd && j < jEnd)
+        {
+            if (hub_[i] < hub_[j])
+                ++i;
+            else if (hub_[j] < hub_[i])
+                ++j;
+            else
+            {
+                size_t d = (size_t)dist_[i] + dist_[j] + extra;
+                if (d < best)
+                    best = d;
+                ++i;
+                ++j;
+            }
+        }
+        return best;
+    }
+
+    template < class G >
+    void LabelIndex<G>::Relabel (const fsu::Vector<Vertex> & perm)
+    {
+        if (!Built())
+            return;
+        size_t n = perm.Size();
+        fsu::Vector<uint64_t> offset(n + 1);
+        fsu::Vector<Vertex> old(n); //old[new] = old
+        for (size_t v = 0; v < n; ++v)
+            old[perm[v]] = (Vertex)v;
+        offset[0] = 0;
+        for (size_t v = 0; v < n; ++v)
+            offset[v + 1] = offset[v] + LabelSize(old[v]);
+        fsu::Vector<Vertex> hub(offset[n]);
+        fsu::Vector<Entry> dist(offset[n]);
+        for (size_t v = 0; v < n; ++v)
+        {
+            size_t size = LabelSize(old[v]);
+            if (size == 0) continue;
+            memcpy(hub.Begin() + offset[v], hub_ + offset_[old[v]], size * sizeof(Vertex));
+            memcpy(dist.Begin() + offset[v], dist_ + offset_[old[v]], size);
+        }
+        Unmap();
+        offsetStore_.Swap(offset);
+        hubStore_.Swap(hub);
+        distStore_.Swap(dist);
+        Own();
+    }
+
+    template < class G >
+    void LabelIndex<G>::Unmap ()
+    {
+#ifdef PLL_MMAP
+        if (map_ != 0)
+            munmap(map_, mapSize_);
+#endif
+        map_ = 0;
+        mapSize_ = 0;
+    }
+
+    template < class G >
+    void LabelIndex<G>::Clear ()
+    {
+        Unmap();
+        offsetStore_.Clear();
+        hubStore_.Clear();
+        distStore_.Clear();
+        offset_ = 0;
+        hub_ = 0;
+        dist_ = 0;
+    }
+
+    template < class G >
+    uint64_t LabelIndex<G>::Fingerprint () const
+    {
+        uint64_t h = 14695981039346656037ULL;
+        for (Vertex v = 0; v < g_.VrtxSize(); ++v)
+        {
+            h ^= (uint64_t)g_.OutDegree(v);
+            h *= 1099511628211ULL;
+        }
+        return h;
+    }
+
+    template < class G >
+    bool LabelIndex<G>::Check (const Header & h, const char * filename) const
+    {
+        if (memcmp(h.magic_, "KBPL", 4) != 0 || h.version_ != 1 || h.vertexSize_ != sizeof(Vertex))
+        {
+            std::cerr << " ** LabelIndex: " << filename << " is not a label index for "
+                      << 8 * sizeof(Vertex) << "-bit vertex ids\n";
+            return 0;
+        }
+        if (h.vrtxSize_ != g_.VrtxSize() || h.edgeSize_ != g_.EdgeSize() || h.fingerprint_ != Fingerprint())
+        {
+            std::cerr << " ** LabelIndex: " << filename << " was built for a different graph or vertex order\n";
+            return 0;
+        }
+        return 1;
+    }
+
+    template < class G >
+    bool LabelIndex<G>::Save (const char * filename) const
+    {
+        if (!Built())
+            return 0;
+        std::ofstream out(filename, std::ios::out | std::ios::binary);
+        if (!out)
+        {
+            std::cerr << " ** LabelIndex::Save: cannot open " << filename << '\n';
+            return 0;
+        }
+        Header h;
+        memset(&h, 0, sizeof(h));
+        memcpy(h.magic_, "KBPL", 4);
+        h.version_ = 1;
+        h.vertexSize_ = sizeof(Vertex);
+        h.vrtxSize_ = g_.VrtxSize();
+        h.edgeSize_ = g_.EdgeSize();
+        h.fingerprint_ = Fingerprint();
+        h.entries_ = Entries();
+        out.write((const char*)&h, sizeof(h));
+        out.write((const char*)offset_, (g_.VrtxSize() + 1) * sizeof(uint64_t));
+        out.write((const char*)hub_, Entries() * sizeof(Vertex));
+        out.write((const char*)dist_, Entries());
+        return (bool)out;
+    }
+
+    template < class G >
+    bool LabelIndex<G>::Load (const char * filename)
+    {
+        std::ifstream in(filename, std::ios::in | std::ios::binary);
+        if (!in)
+            return 0; //no saved index; not an error
+        Header h;
+        in.read((char*)&h, sizeof(h));
+        if (!in || !Check(h, filename))
+            return 0;
+        Clear();
+        offsetStore_.SetSize(h.vrtxSize_ + 1);
+        hubStore_.SetSize(h.entries_);
+        distStore_.SetSize(h.entries_);
+        in.read((char*)offsetStore_.Begin(), offsetStore_.Size() * sizeof(uint64_t));
+        in.read((char*)hubStore_.Begin(), hubStore_.Size() * sizeof(Vertex));
+        in.read((char*)distStore_.Begin(), distStore_.Size());
+        if (!in)
+        {
+            std::cerr << " ** LabelIndex::Load: " << filename << " is truncated\n";
+            Clear();
+            return 0;
+        }
+        Own();
+        return 1;
+    }
+
+    template < class G >
+    bool LabelIndex<G>::Map (const char * filename)
+    {
+#ifdef PLL_MMAP
+        int fd = open(filename, O_RDONLY);
+        if (fd < 0)
+            return 0; //no saved index; not an error
+        struct stat st;
+        if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(Header))
+        {
+            close(fd);
+            std::cerr << " ** LabelIndex::Map: " << filename << " is not a label index\n";
+            return 0;
+        }
+        void * map = mmap(0, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd); //the mapping keeps the file open
+        if (map == MAP_FAILED)
+        {
+            std::cerr << " ** LabelIndex::Map: cannot map " << filename << '\n';
+            return 0;
+        }
+        const Header & h = *(const Header*)map;
+        size_t offsetBytes = (h.vrtxSize_ + 1) * sizeof(uint64_t);
+        if (!Check(h, filename) || (size_t)st.st_size != sizeof(Header) + offsetBytes + h.entries_ * (sizeof(Vertex) + sizeof(Entry)))
+        {
+            munmap(map, (size_t)st.st_size);
+            return 0;
+        }
+        Clear();
+        map_ = map;
+        mapSize_ = (size_t)st.st_size;
+        const char * p = (const char*)map + sizeof(Header);
+        offset_ = (const uint64_t*)p;
+        hub_ = (const Vertex*)(p + offsetBytes);
+        dist_ = (const Entry*)(p + offsetBytes + h.entries_ * sizeof(Vertex));
+        return 1;
+#else
+        return Load(filename);
+#endif
+    }
+
+} //end namespace fsu
+
+#endif /* PLL_H */
@@ -0,0 +1,290 @@
+/*
+    spaths.h
+    Andrew J Wood
+    COP 4530
+
+    Defines and implements ShortestPaths, which answers "how many shortest
+    paths" and "show me the first k of them" on top of a finished BFSurvey.
+
+    No extra state is recorded during the survey.  The shortest-path DAG is
+    implicit in the distances: u is a predecessor of v exactly when u and v
+    are adjacent and distance[u] + 1 == distance[v].  Every vertex at distance
+    d > 0 has at least one predecessor, so walking predecessors from any
+    reached vertex always ends at the search origin with no dead ends.
+
+        PathCount(v)    number of shortest paths from the origin to v.  Only
+                        the backward cone of v (its ancestors in the DAG) is
+                        visited, and counts are memoized, so later queries
+                        stop where earlier ones left off.  Counts saturate at
+                        MaxCount() instead of overflowing.
+        RandomPath(v)   one shortest path to v drawn uniformly at random: at
+                        each step back the next vertex is a predecessor p
+                        chosen with probability PathCount(p) / PathCount(x).
+                        Once the counts along the way are known (memoized),
+                        a draw costs one pass over each path vertex's
+                        neighbors.  R is any generator whose operator ()
+                        returns at least 32 random bits, e.g. fsu::RandomBase.
+        Enumerator      yields the shortest paths to v one at a time, depth
+                        first over predecessors, in the same form as
+                        MovieMatch::MovieDistance: v first, origin last.
+                        Each path costs O(sum of degrees along it).
+
+    The graph and survey must not change while a ShortestPaths refers to them;
+    call Reset() after the survey is re-run.
+
+    Note that the code is self-documenting.
+ */
+
+#ifndef SPATHS_H
+#define SPATHS_H
+
+#include <cstdlib>
+#include <limits>
+#include <vector.h>
+#include <list.h>
+#include <bfsurvey.h>
+
+namespace fsu {
+
+    template < class G >
+    class ShortestPaths
+    {
+    public:
+
+        typedef G                           Graph;
+        typedef typename Graph::Vertex      Vertex;
+        typedef typename Graph::AdjIterator AdjIterator;
+        typedef fsu::BFSurvey<Graph>        Survey;
+        typedef unsigned long long          Count;
+        typedef fsu::List<Vertex>           Path;
+
+        //walks the shortest paths to one vertex lazily
+        class Enumerator
+        {
+        public:
+            Enumerator  (const ShortestPaths & sp, Vertex v);
+            bool Next   (Path & path); //0 when every path has been produced
+
+        private:
+            void Descend (); //extends the stack to the origin along first predecessors
+
+            const ShortestPaths &   sp_;
+            fsu::Vector<Vertex>     vrtx_;  //vrtx_[k] = vertex at depth k of the current path
+            fsu::Vector<AdjIterator> next_; //next_[k] = next neighbor of vrtx_[k] to try
+            bool                    done_;
+            bool                    started_;
+        };
+
+                ShortestPaths   (const Graph & g, const Survey & bfs);
+        void    Reset           (); //forget memoized counts after the survey is re-run
+
+        bool    Reached         (Vertex v) const {return bfs_.Distance()[v] < (Vertex)bfs_.InfiniteDistance();}
+        Count   PathCount       (Vertex v);
+        size_t  Paths           (Vertex v, size_t k, fsu::Vector<Path> & paths) const; //first k paths; returns count
+        template < class R >
+        bool    RandomPath      (Vertex v, R & random, Path & path); //0 if v is not reached
+
+        static Count MaxCount   () {return std::numeric_limits<Count>::max();}
+
+    private:
+
+        bool    IsPred          (Vertex u, Vertex v) const {return bfs_.Distance()[u] + 1 == bfs_.Distance()[v];}
+
+        const Graph &           g_;
+        const Survey &          bfs_;
+        fsu::Vector<Count>      count_;     //memoized path counts; 0 = not yet known
+        fsu::Vector<Vertex>     cone_;      //scratch: ancestors of the current query
+        fsu::Vector<char>       inCone_;
+
+    }; //end class ShortestPaths
+
+
+    //----
+    //ShortestPaths implementations
+    //----
+
+    template < class G >
+    ShortestPaths<G>::ShortestPaths (const Graph & g, const Survey & bfs)
+    :   g_(g), bfs_(bfs), count_(g.VrtxSize(), 0), cone_(), inCone_(g.VrtxSize(), 0)
+    {}
+
+    template < class G >
+    void ShortestPaths<G>::Reset ()
+    {
+        count_.SetSize(g_.VrtxSize());
+        inCone_.SetSize(g_.VrtxSize());
+        for (size_t x = 0; x < count_.Size(); ++x)
+        {
+            count_[x] = 0;
+            inCone_[x] = 0;
+        }
+    }
+
+    template < class G >
+    typename ShortestPaths<G>::Count ShortestPaths<G>::PathCount (Vertex v)
+    {
+        if (!Reached(v))
+            return 0;
+        if (count_[v] != 0)
+            return count_[v];
+
+        //collect the not-yet-counted ancestors of v; the cone is built in
+        //nonincreasing distance order, since it grows one layer back at a time
+        cone_.Clear();
+        cone_.PushBack(v);
+        inCone_[v] = 1;
+        AdjIterator i;
+        for (size_t head = 0; head < cone_.Size(); ++head)
+        {
+            Vertex x = cone_[head];
+            for (i = g_.Begin(x); i != g_.End(x); ++i)
+            {
+                if (IsPred(*i, x) && count_[*i] == 0 && !inCone_[*i])
+                {
+                    inCone_[*i] = 1;
+                    cone_.PushBack(*i);
+                }
+            }
+        }
+
+        //sum predecessor counts from the far end of the cone forward
+        for (size_t k = cone_.Size(); k > 0; --k)
+        {
+            Vertex x = cone_[k-1];
+            inCone_[x] = 0;
+            if (bfs_.Distance()[x] == 0)
+            {
+                count_[x] = 1;
+                continue;
+            }
+            Count c = 0;
+            for (i = g_.Begin(x); i != g_.End(x); ++i)
+            {
+                if (IsPred(*i, x))
+                {
+                    Count p = count_[*i];
+                    c = (c > MaxCount() - p) ? MaxCount() : c + p; //saturate
+                }
+            }
+            count_[x] = c;
+        }
+        return count_[v];
+    }
+
+    template < class G >
+    size_t ShortestPaths<G>::Paths (Vertex v, size_t k, fsu::Vector<Path> & paths) const
+    {
+        paths.Clear();
+        if (!Reached(v))
+            return 0;
+        Enumerator e(*this, v);
+        Path path;
+        while (paths.Size() < k && e.Next(path))
+            paths.PushBack(path);
+        return paths.Size();
+    }
+
+
+    template < class G >
+    template < class R >
+    bool ShortestPaths<G>::RandomPath (Vertex v, R & random, Path & path)
+    {
+        path.Clear();
+        if (!Reached(v))
+            return 0;
+        PathCount(v); //fills the counts of every ancestor of v
+        path.PushBack(v);
+        AdjIterator i;
+        while (bfs_.Distance()[v] > 0)
+        {
+            //r uniform in [0, count); the predecessor whose count range holds r is next
+            Count r = (((Count)random() << 32) | (Count)(random() & 0xFFFFFFFF)) % count_[v];
+            Vertex next = v;
+            for (i = g_.Begin(v); i != g_.End(v); ++i)
+            {
+                if (!IsPred(*i, v))
+                    continue;
+                next = *i;
+                if (r < count_[*i])
+                    break;
+                r -= count_[*i];
+            }
+            v = next;
+            path.PushBack(v);
+        }
+        return 1;
+    }
+
+
+    //----
+    //Enumerator implementations
+    //----
+
+    template < class G >
+    ShortestPaths<G>::Enumerator::Enumerator (const ShortestPaths & sp, Vertex v)
+    :   sp_(sp), vrtx_(), next_(), done_(!sp.Reached(v)), started_(0)
+    {
+        if (done_) return;
+        size_t d = sp_.bfs_.Distance()[v];
+        vrtx_.SetCapacity(d + 1);
+        next_.SetCapacity(d + 1);
+        vrtx_.PushBack(v);
+        next_.PushBack(sp_.g_.Begin(v));
+    }
+
+    template < class G >
+    void ShortestPaths<G>::Enumerator::Descend ()
+    {
+        //the top of the stack has an untried predecessor at next_.Back(), or is the origin
+        while (sp_.bfs_.Distance()[vrtx_.Back()] > 0)
+        {
+            Vertex x = vrtx_.Back();
+            AdjIterator & i = next_.Back();
+            while (!sp_.IsPred(*i, x))
+                ++i;
+            Vertex p = *i;
+            ++i;
+            vrtx_.PushBack(p);
+            next_.PushBack(sp_.g_.Begin(p));
+        }
+    }
+
+    template < class G >
+    bool ShortestPaths<G>::Enumerator::Next (Path & path)
+    {
+        if (done_)
+            return 0;
+        if (started_)
+        {
+            //backtrack to the deepest vertex with another predecessor to try
+            vrtx_.PopBack();
+            next_.PopBack();
+            for (;;)
+            {
+                if (vrtx_.Empty())
+                {
+                    done_ = 1;
+                    return 0;
+                }
+                Vertex x = vrtx_.Back();
+                AdjIterator & i = next_.Back();
+                while (i != sp_.g_.End(x) && !sp_.IsPred(*i, x))
+                    ++i;
+                if (i != sp_.g_.End(x))
+                    break;
+                vrtx_.PopBack();
+                next_.PopBack();
+            }
+        }
+        started_ = 1;
+        Descend();
+
+        path.Clear();
+        for (size_t k = 0; k < vrtx_.Size(); ++k)
+            path.PushBack(vrtx_[k]);
+        return 1;
+    }
+
+} //end namespace fsu
+
+#endif /* SPATHS_H */
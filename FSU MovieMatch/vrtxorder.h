@@ -0,0 +1,316 @@
+/*
+    vrtxorder.h
+    Andrew J Wood
+    COP 4530
+
+    Vertex orderings for locality.
+
+    Each function computes a permutation of the vertices of a graph g and
+    returns it as perm, where perm[old] = new.  Renumbering a graph by one of
+    these orderings places vertices that are visited together close together
+    in memory, so a traversal touches fewer cache lines.
+
+        BFSOrder        breadth-first discovery order from a start vertex
+                        (default: the vertex of largest degree)
+        DegreeOrder     degree descending, ties broken by old id
+        RCMOrder        Reverse Cuthill-McKee: per component, BFS from a
+                        minimum degree vertex visiting neighbors by increasing
+                        degree, then the whole order reversed
+        CommunityOrder  label propagation groups vertices into communities;
+                        communities are laid out in the order they are reached
+                        by BFS from the largest hub, and vertices within a
+                        community keep that BFS order (in the spirit of
+                        Rabbit order, without the incremental aggregation)
+
+    Components not reached from the start vertex are appended in order of
+    their smallest old id, so every ordering is a full permutation.
+
+    G must provide Vertex, AdjIterator, VrtxSize(), OutDegree(), Begin(), End().
+
+    Note that the code is self-documenting.
+ */
+
+#ifndef VRTXORDER_H
+#define VRTXORDER_H
+
+#include <cstdlib>
+#include <cstring>
+#include <vector.h>
+#include <gheap.h>
+
+namespace fsu {
+
+    //the orderings understood by Reorder clients
+    enum VertexOrder { loadOrder, bfsOrder, degreeOrder, rcmOrder, communityOrder };
+
+    //parses "load", "bfs", "degree", "rcm", "community"; returns 0 if unrecognized
+    inline bool ParseVertexOrder (const char * s, VertexOrder & order)
+    {
+        if      (0 == strcmp(s, "load"))        order = loadOrder;
+        else if (0 == strcmp(s, "bfs"))         order = bfsOrder;
+        else if (0 == strcmp(s, "degree"))      order = degreeOrder;
+        else if (0 == strcmp(s, "rcm"))         order = rcmOrder;
+        else if (0 == strcmp(s, "community"))   order = communityOrder;
+        else return 0;
+        return 1;
+    }
+
+    //----
+    //helpers
+    //----
+
+    //vertex of largest degree (smallest id among ties)
+    template < class G >
+    typename G::Vertex MaxDegreeVertex (const G & g)
+    {
+        typedef typename G::Vertex Vertex;
+        Vertex hub = 0;
+        for (Vertex v = 1; v < g.VrtxSize(); ++v)
+        {
+            if (g.OutDegree(v) > g.OutDegree(hub))
+                hub = v;
+        }
+        return hub;
+    }
+
+    //stable counting sort of the vertices by degree; ascending or descending
+    template < class G >
+    void SortByDegree (const G & g, fsu::Vector<typename G::Vertex> & sorted, bool descending)
+    {
+        typedef typename G::Vertex Vertex;
+        size_t n = g.VrtxSize();
+        size_t maxDegree = 0;
+        for (Vertex v = 0; v < n; ++v)
+        {
+            if (g.OutDegree(v) > maxDegree)
+                maxDegree = g.OutDegree(v);
+        }
+        fsu::Vector<size_t> start(maxDegree + 2, 0);
+        for (Vertex v = 0; v < n; ++v)
+            ++start[(descending ? maxDegree - g.OutDegree(v) : g.OutDegree(v)) + 1];
+        for (size_t d = 1; d < start.Size(); ++d)
+            start[d] += start[d-1];
+        sorted.SetSize(n);
+        for (Vertex v = 0; v < n; ++v)
+            sorted[start[descending ? maxDegree - g.OutDegree(v) : g.OutDegree(v)]++] = v;
+    }
+
+    //orders vertices by a precomputed rank, e.g. position in degree order
+    template < typename Vertex >
+    class RankLessThan
+    {
+    public:
+        explicit RankLessThan (const fsu::Vector<Vertex> & rank) : rank_(rank) {}
+        bool operator () (Vertex a, Vertex b) const {return rank_[a] < rank_[b];}
+    private:
+        const fsu::Vector<Vertex> & rank_;
+    };
+
+    //inverts a visit sequence (seq[new] = old) into perm[old] = new
+    template < typename Vertex >
+    void InvertOrder (const fsu::Vector<Vertex> & seq, fsu::Vector<Vertex> & perm)
+    {
+        perm.SetSize(seq.Size());
+        for (size_t i = 0; i < seq.Size(); ++i)
+            perm[seq[i]] = (Vertex)i;
+    }
+
+    //appends the BFS sequence from start to seq, marking visited vertices
+    template < class G >
+    void AppendBFS (const G & g, typename G::Vertex start, fsu::Vector<char> & seen,
+                    fsu::Vector<typename G::Vertex> & seq)
+    {
+        typename G::AdjIterator i;
+        size_t head = seq.Size();
+        seen[start] = 1;
+        seq.PushBack(start);
+        while (head < seq.Size())
+        {
+            typename G::Vertex front = seq[head++];
+            for (i = g.Begin(front); i != g.End(front); ++i)
+            {
+                if (!seen[*i])
+                {
+                    seen[*i] = 1;
+                    seq.PushBack(*i);
+                }
+            }
+        }
+    }
+
+    //----
+    //orderings
+    //----
+
+    template < class G >
+    void BFSOrder (const G & g, typename G::Vertex start, fsu::Vector<typename G::Vertex> & perm)
+    {
+        typedef typename G::Vertex Vertex;
+        size_t n = g.VrtxSize();
+        fsu::Vector<char> seen(n, 0);
+        fsu::Vector<Vertex> seq;
+        seq.SetCapacity(n);
+        if (n > 0)
+            AppendBFS(g, start, seen, seq);
+        for (Vertex v = 0; v < n; ++v)
+        {
+            if (!seen[v])
+                AppendBFS(g, v, seen, seq);
+        }
+        InvertOrder(seq, perm);
+    }
+
+    template < class G >
+    void BFSOrder (const G & g, fsu::Vector<typename G::Vertex> & perm)
+    {
+        BFSOrder(g, g.VrtxSize() > 0 ? MaxDegreeVertex(g) : 0, perm);
+    }
+
+    template < class G >
+    void DegreeOrder (const G & g, fsu::Vector<typename G::Vertex> & perm)
+    {
+        fsu::Vector<typename G::Vertex> seq;
+        SortByDegree(g, seq, 1);
+        InvertOrder(seq, perm);
+    }
+
+    template < class G >
+    void RCMOrder (const G & g, fsu::Vector<typename G::Vertex> & perm)
+    {
+        typedef typename G::Vertex Vertex;
+        size_t n = g.VrtxSize();
+        fsu::Vector<Vertex> byDegree;
+        SortByDegree(g, byDegree, 0); //ascending: roots are minimum degree vertices
+
+        //rank[v] = position of v in ascending degree order, used to sort neighbor batches
+        fsu::Vector<Vertex> rank;
+        InvertOrder(byDegree, rank);
+        RankLessThan<Vertex> byRank(rank);
+
+        fsu::Vector<char> seen(n, 0);
+        fsu::Vector<Vertex> seq;
+        seq.SetCapacity(n);
+        typename G::AdjIterator i;
+        for (size_t r = 0; r < n; ++r)
+        {
+            Vertex root = byDegree[r];
+            if (seen[root]) continue;
+            size_t head = seq.Size();
+            seen[root] = 1;
+            seq.PushBack(root);
+            while (head < seq.Size())
+            {
+                Vertex front = seq[head++];
+                size_t batch = seq.Size();
+                for (i = g.Begin(front); i != g.End(front); ++i)
+                {
+                    if (!seen[*i])
+                    {
+                        seen[*i] = 1;
+                        seq.PushBack(*i);
+                    }
+                }
+                //the newly discovered batch is visited by increasing degree
+                fsu::g_heap_sort(seq.Begin() + batch, seq.End(), byRank);
+            }
+        }
+        //reverse
+        for (size_t lo = 0, hi = n; lo + 1 < hi; ++lo, --hi)
+            fsu::Swap(seq[lo], seq[hi-1]);
+        InvertOrder(seq, perm);
+    }
+
+    template < class G >
+    void CommunityOrder (const G & g, fsu::Vector<typename G::Vertex> & perm, size_t rounds = 5)
+    {
+        typedef typename G::Vertex Vertex;
+        size_t n = g.VrtxSize();
+        typename G::AdjIterator i;
+
+        //label propagation: each vertex adopts the most frequent label among its neighbors
+        fsu::Vector<Vertex> label(n);
+        for (Vertex v = 0; v < n; ++v)
+            label[v] = v;
+        fsu::Vector<size_t> count(n, 0);
+        fsu::Vector<Vertex> touched;
+        for (size_t round = 0; round < rounds; ++round)
+        {
+            size_t changed = 0;
+            for (Vertex v = 0; v < n; ++v)
+            {
+                touched.Clear();
+                for (i = g.Begin(v); i != g.End(v); ++i)
+                {
+                    if (count[label[*i]]++ == 0)
+                        touched.PushBack(label[*i]);
+                }
+                Vertex best = label[v];
+                size_t bestCount = 0;
+                for (size_t k = 0; k < touched.Size(); ++k)
+                {
+                    Vertex l = touched[k];
+                    if (count[l] > bestCount || (count[l] == bestCount && l < best))
+                    {
+                        best = l;
+                        bestCount = count[l];
+                    }
+                    count[l] = 0;
+                }
+                if (bestCount > 0 && best != label[v])
+                {
+                    label[v] = best;
+                    ++changed;
+                }
+            }
+            if (changed == 0) break;
+        }
+
+        //BFS sequence from the hub fixes the order of communities and of their members
+        fsu::Vector<Vertex> bfsPerm, seq;
+        BFSOrder(g, bfsPerm);
+        seq.SetSize(n);
+        for (Vertex v = 0; v < n; ++v)
+            seq[bfsPerm[v]] = v;
+
+        //first[l] = rank of community l by first BFS appearance; then bucket by community
+        fsu::Vector<size_t> start(n + 1, 0);
+        fsu::Vector<Vertex> commRank(n, (Vertex)n);
+        size_t communities = 0;
+        for (size_t k = 0; k < n; ++k)
+        {
+            Vertex l = label[seq[k]];
+            if (commRank[l] == (Vertex)n)
+                commRank[l] = (Vertex)communities++;
+            ++start[commRank[l] + 1];
+        }
+        for (size_t c = 1; c <= communities; ++c)
+            start[c] += start[c-1];
+        perm.SetSize(n);
+        for (size_t k = 0; k < n; ++k)
+        {
+            Vertex v = seq[k];
+            perm[v] = (Vertex)start[commRank[label[v]]]++;
+        }
+    }
+
+    //dispatches on order; loadOrder yields the identity
+    template < class G >
+    void ComputeOrder (const G & g, VertexOrder order, fsu::Vector<typename G::Vertex> & perm)
+    {
+        typedef typename G::Vertex Vertex;
+        switch (order)
+        {
+            case bfsOrder:          BFSOrder(g, perm);          break;
+            case degreeOrder:       DegreeOrder(g, perm);       break;
+            case rcmOrder:          RCMOrder(g, perm);          break;
+            case communityOrder:    CommunityOrder(g, perm);    break;
+            default:
+                perm.SetSize(g.VrtxSize());
+                for (Vertex v = 0; v < g.VrtxSize(); ++v)
+                    perm[v] = v;
+        }
+    }
+
+} //end namespace fsu
+
+#endif /* VRTXORDER_H */
@@ -3,12 +3,13 @@
     01/30/17
     Chris Lacher
 
-    BitVector class implementation - array of unsigned char version
+    BitVector class implementation - array of 64-bit words version
 
     Copyright 2017, R.C. Lacher
 */
 
 #include <iostream>
+#include <cstring>
 #include <bitvect.h>
 
 namespace fsu
@@ -20,17 +21,11 @@ namespace fsu
   }
 
   bool operator== (const BitVector& v1 , const BitVector& v2)
+  // bits past Size() are always 0, so whole words can be compared
   {
     if (v1.Size() != v2.Size())
       return 0;
-    for (size_t i = 0; i < v1.Size(); ++i)
-    {
-      if (v1.Test(i) && !v2.Test(i))
-        return 0;
-      if (v2.Test(i) && !v2.Test(i))
-        return 0;
-    }
-    return 1;
+    return 0 == memcmp(v1.wordArray_, v2.wordArray_, v1.wordArraySize_ * sizeof(uint64_t));
   }
 
   std::ostream& operator << (std::ostream& os, const BitVector& bv)
@@ -49,24 +44,22 @@ namespace fsu
   void BitVector::Expand (size_t newsize) // increase number of bits, retaining current values
   {
     if (newsize <= Size()) return; // nothing to do
-    size_t newByteArraySize = (newsize + 7)/8;
-    unsigned char * newByteArray = new (std::nothrow) unsigned char [newByteArraySize];
-    if (newByteArray == nullptr) // handle exception locally
-    {
-      std::cerr << "** BitVector::Expand error: memory allocation failure -- state unchanged.\n";
-      return;
-    }
-    for (size_t i = 0; i < byteArraySize_; ++i)
-    {
-      newByteArray[i] = byteArray_[i];
-    }
-    for (size_t i = byteArraySize_; i < newByteArraySize; ++i)
+    size_t newWordArraySize = (newsize + 63)/64;
+    if (newWordArraySize > wordArraySize_)
     {
-      newByteArray[i] = 0x00;
+      uint64_t * newWordArray = new (std::nothrow) uint64_t [newWordArraySize];
+      if (newWordArray == nullptr) // handle exception locally
+      {
+        std::cerr << "** BitVector::Expand error: memory allocation failure -- state unchanged.\n";
+        return;
+      }
+      memcpy(newWordArray, wordArray_, wordArraySize_ * sizeof(uint64_t));
+      memset(newWordArray + wordArraySize_, 0, (newWordArraySize - wordArraySize_) * sizeof(uint64_t));
+      delete [] wordArray_;
+      wordArraySize_ = newWordArraySize;
+      wordArray_ = newWordArray;
     }
-    delete [] byteArray_;
-    byteArraySize_ = newByteArraySize;
-    byteArray_ = newByteArray;
+    size_ = 8 * ((newsize + 7)/8);
   }
 
   void BitVector::Dump  (std::ostream& os) const
@@ -82,131 +75,235 @@ namespace fsu
 
   BitVector::BitVector (size_t numbits) // constructor
   {
-    byteArraySize_ = (numbits + 7)/8;
-    if (byteArraySize_ == 0) byteArraySize_ = 1;
-    byteArray_ = new (std::nothrow) unsigned char [byteArraySize_];
-    if (byteArray_ == nullptr) // handle exception locally
+    size_ = 8 * ((numbits + 7)/8);
+    if (size_ == 0) size_ = 8;
+    wordArraySize_ = (size_ + 63)/64;
+    wordArray_ = new (std::nothrow) uint64_t [wordArraySize_];
+    if (wordArray_ == nullptr) // handle exception locally
     {
       std::cerr << "** BitVector error: memory allocation failure -- terminating program.\n";
       exit (EXIT_FAILURE);
     }
-    for (size_t i = 0; i < byteArraySize_; ++i)
-      byteArray_[i] = 0x00;
+    memset(wordArray_, 0, wordArraySize_ * sizeof(uint64_t));
   }
 
-  BitVector::BitVector (const BitVector& bv)  // copy constructor      
+  BitVector::BitVector (const BitVector& bv)  // copy constructor
   {
-    byteArraySize_ = bv.byteArraySize_;
-    byteArray_ = new (std::nothrow) unsigned char [byteArraySize_];
-    if (byteArray_ == nullptr) // handle exception locally
+    size_ = bv.size_;
+    wordArraySize_ = bv.wordArraySize_;
+    wordArray_ = new (std::nothrow) uint64_t [wordArraySize_];
+    if (wordArray_ == nullptr) // handle exception locally
     {
       std::cerr << "** BitVector error: memory allocation failure -- terminating program.\n";
       exit (EXIT_FAILURE);
     }
-    for (size_t i = 0; i < byteArraySize_; ++i)
-      byteArray_[i] = bv.byteArray_[i];
+    memcpy(wordArray_, bv.wordArray_, wordArraySize_ * sizeof(uint64_t));
   }
 
   BitVector::~BitVector ()  // destructor
   {
-    delete [] byteArray_;
+    delete [] wordArray_;
   }
 
-  BitVector& BitVector::operator = (const BitVector& bv)  
+  BitVector& BitVector::operator = (const BitVector& bv)
   // assignment operator
   {
     if (this != &bv)
     {
-      if (byteArraySize_ != bv.byteArraySize_)
+      if (wordArraySize_ != bv.wordArraySize_)
       {
-	delete [] byteArray_;
-	byteArraySize_ = bv.byteArraySize_;
-	byteArray_ = new (std::nothrow) unsigned char [byteArraySize_];
-	if (byteArray_ == nullptr) // handle exception locally
+	delete [] wordArray_;
+	wordArraySize_ = bv.wordArraySize_;
+	wordArray_ = new (std::nothrow) uint64_t [wordArraySize_];
+	if (wordArray_ == nullptr) // handle exception locally
 	{
 	  std::cerr << "** BitVector error: memory allocation failure -- terminating program.\n";
 	  exit (EXIT_FAILURE);
 	}
       }
-      for (size_t i = 0; i < byteArraySize_; ++i)
-	byteArray_[i] = bv.byteArray_[i];
+      size_ = bv.size_;
+      memcpy(wordArray_, bv.wordArray_, wordArraySize_ * sizeof(uint64_t));
     }
     return *this;
   }
 
-  size_t BitVector::Size() const      
+  size_t BitVector::Size() const
   // return size of bitvector
   {
-    return 8 * byteArraySize_;
+    return size_;
   }
 
-  void BitVector::Set ()  
+  void BitVector::Set ()
   // make all bits = 1
   {
-    for (size_t i = 0; i < byteArraySize_; ++i)
-      byteArray_[i] = 0xFF;
+    memset(wordArray_, 0xFF, wordArraySize_ * sizeof(uint64_t));
+    Trim();
   }
 
-  void BitVector::Set (size_t index)  
+  void BitVector::Set (size_t index)
   // make bit = 1: OR with mask
   {
-    byteArray_[ByteNumber(index)] |= Mask(index);
+    wordArray_[WordNumber(index)] |= Mask(index);
   }
 
-  void BitVector::Unset ()  
+  void BitVector::Unset ()
   // make all bits = 0
   {
-    for (size_t i = 0; i < byteArraySize_; ++i)
-      byteArray_[i] = 0x00;
+    memset(wordArray_, 0, wordArraySize_ * sizeof(uint64_t));
   }
 
-  void BitVector::Unset (size_t index)  
+  void BitVector::Unset (size_t index)
   // make bit = 0: AND with inverted mask
   {
-    byteArray_[ByteNumber(index)] &= ~ Mask(index);
+    wordArray_[WordNumber(index)] &= ~ Mask(index);
   }
 
-  void BitVector::Flip ()  
+  void BitVector::Flip ()
   // change all bit values
   {
-    for (size_t i = 0; i < byteArraySize_; ++i)
-      byteArray_[i] ^= 0xFF;
+    for (size_t i = 0; i < wordArraySize_; ++i)
+      wordArray_[i] = ~ wordArray_[i];
+    Trim();
   }
 
-  void BitVector::Flip (size_t index)  
+  void BitVector::Flip (size_t index)
   // change bit value: XOR with mask
   {
-    byteArray_[ByteNumber(index)] ^= Mask(index);
+    wordArray_[WordNumber(index)] ^= Mask(index);
   }
 
-  bool BitVector::Test  (size_t index) const  
+  bool BitVector::Test  (size_t index) const
   // return bit value
   {
-    return 0 != (byteArray_[ByteNumber(index)] & Mask(index));
+    return 0 != (wordArray_[WordNumber(index)] & Mask(index));
+  }
+
+  size_t BitVector::Count () const
+  // number of bits = 1
+  {
+    size_t count = 0;
+    for (size_t i = 0; i < wordArraySize_; ++i)
+      count += PopCount(wordArray_[i]);
+    return count;
+  }
+
+  size_t BitVector::FindFirst () const
+  // index of first bit = 1, or Size() if none
+  {
+    for (size_t i = 0; i < wordArraySize_; ++i)
+      if (wordArray_[i] != 0)
+        return 64 * i + LowBit(wordArray_[i]);
+    return size_;
+  }
+
+  size_t BitVector::FindNext (size_t index) const
+  // index of first bit = 1 after index, or Size() if none
+  {
+    ++index;
+    if (index >= size_)
+      return size_;
+    size_t i = index >> 6;
+    uint64_t w = wordArray_[i] & (~(uint64_t)0 << (index & (size_t)0x3F)); // drop bits below index
+    while (w == 0)
+    {
+      if (++i == wordArraySize_)
+        return size_;
+      w = wordArray_[i];
+    }
+    return 64 * i + LowBit(w);
+  }
+
+  void BitVector::And (const BitVector& b)
+  // bit = bit & b.bit; bits past b.Size() become 0
+  {
+    size_t n = (wordArraySize_ < b.wordArraySize_) ? wordArraySize_ : b.wordArraySize_;
+    for (size_t i = 0; i < n; ++i)
+      wordArray_[i] &= b.wordArray_[i];
+    if (n < wordArraySize_)
+      memset(wordArray_ + n, 0, (wordArraySize_ - n) * sizeof(uint64_t));
+  }
+
+  void BitVector::Or (const BitVector& b)
+  // bit = bit | b.bit; bits of b past Size() are ignored
+  {
+    size_t n = (wordArraySize_ < b.wordArraySize_) ? wordArraySize_ : b.wordArraySize_;
+    for (size_t i = 0; i < n; ++i)
+      wordArray_[i] |= b.wordArray_[i];
+    Trim();
+  }
+
+  void BitVector::Xor (const BitVector& b)
+  // bit = bit ^ b.bit; bits of b past Size() are ignored
+  {
+    size_t n = (wordArraySize_ < b.wordArraySize_) ? wordArraySize_ : b.wordArraySize_;
+    for (size_t i = 0; i < n; ++i)
+      wordArray_[i] ^= b.wordArray_[i];
+    Trim();
+  }
+
+  void BitVector::AndNot (const BitVector& b)
+  // bit = bit & ~b.bit
+  {
+    size_t n = (wordArraySize_ < b.wordArraySize_) ? wordArraySize_ : b.wordArraySize_;
+    for (size_t i = 0; i < n; ++i)
+      wordArray_[i] &= ~ b.wordArray_[i];
+  }
+
+  void BitVector::Swap (BitVector& b)
+  // exchange contents in O(1)
+  {
+    uint64_t * words = wordArray_; wordArray_ = b.wordArray_; b.wordArray_ = words;
+    size_t n = wordArraySize_; wordArraySize_ = b.wordArraySize_; b.wordArraySize_ = n;
+    n = size_; size_ = b.size_; b.size_ = n;
   }
-   
+
   // private methods
 
-  size_t BitVector::ByteNumber (size_t index) const
+  size_t BitVector::WordNumber (size_t index) const
   {
-    // return index / 8
-    // shift right 3 is equivalent to, and faster than, dividing by 8
-    index = index >> 3;
-    if (index >= byteArraySize_)
+    // return index / 64
+    if (index >= size_)
     {
       std::cerr << "** BitVector error: index out of range\n";
       exit (EXIT_FAILURE);
-    } 
-    return index;
+    }
+    return index >> 6;
   }
 
-  unsigned char BitVector::Mask (size_t index)
+  uint64_t BitVector::Mask (size_t index)
   {
-    // return mask for index % 8
-    // the low order 3 bits is the remainder when dividing by 8
-    size_t shiftamount = index & (size_t)0x07;  // low order 3 bits
-    return (unsigned char)0x01 << shiftamount;
+    // return mask for index % 64
+    // the low order 6 bits is the remainder when dividing by 64
+    size_t shiftamount = index & (size_t)0x3F;  // low order 6 bits
+    return (uint64_t)0x01 << shiftamount;
   }
 
-} // namespace fsu
+  void BitVector::Trim ()
+  {
+    size_t used = size_ & (size_t)0x3F;
+    if (used != 0)
+      wordArray_[wordArraySize_ - 1] &= ((uint64_t)0x01 << used) - 1;
+  }
 
+  size_t BitVector::PopCount (uint64_t w)
+  {
+#if defined(__GNUC__) || defined(__clang__)
+    return (size_t)__builtin_popcountll(w);
+#else
+    w = w - ((w >> 1) & 0x5555555555555555ULL);
+    w = (w & 0x3333333333333333ULL) + ((w >> 2) & 0x3333333333333333ULL);
+    w = (w + (w >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (size_t)((w * 0x0101010101010101ULL) >> 56);
+#endif
+  }
+
+  size_t BitVector::LowBit (uint64_t w)
+  {
+#if defined(__GNUC__) || defined(__clang__)
+    return (size_t)__builtin_ctzll(w);
+#else
+    return PopCount((w & (0 - w)) - 1);
+#endif
+  }
+
+} // namespace fsu
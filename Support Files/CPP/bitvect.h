@@ -3,7 +3,14 @@
     01/30/17
     Chris Lacher
 
-    BitVector class - based on array of 8-bit words
+    BitVector class - based on array of 64-bit words
+
+    10/18/26: storage moved from 8-bit to 64-bit words. Size() is unchanged
+    (the requested size rounded up to a whole byte) and the bits past
+    Size() are kept 0, so whole-vector operations work a word at a time:
+    Count (population count), FindFirst/FindNext (next set bit), and
+    And/Or/Xor/AndNot with another BitVector. Fills and copies go through
+    memset/memcpy, which the C library vectorizes.
 
     Copyright 2017, R.C. Lacher
 */
@@ -12,6 +19,7 @@
 #define _BITVECT_H
 
 #include <cstdlib>
+#include <cstdint>
 #include <iostream>
 
 namespace fsu
@@ -25,14 +33,14 @@ namespace fsu
 
   std::ostream& operator << (std::ostream&, const BitVector&);
   bool operator!= (const BitVector& v1 , const BitVector& v2);
-  
+
   class BitVector
   {
   public:
     friend  bool operator== (const BitVector& v1 , const BitVector& v2);
 
     explicit BitVector  (size_t size);       // construct a BitVector with specified size
-             BitVector  (const BitVector&);  // copy constructor      
+             BitVector  (const BitVector&);  // copy constructor
              ~BitVector ();                  // destructor
 
     BitVector& operator = (const BitVector& a);  // assignment operator
@@ -41,22 +49,37 @@ namespace fsu
     void   Set    (size_t index);         // make bit at index = 1
     void   Unset  ();                     // make all bits = 0
     void   Unset  (size_t index);         // make bit at index = 0
-    void   Flip   ();                     // change all bits 
+    void   Flip   ();                     // change all bits
     void   Flip   (size_t index);         // change bit at index
     bool   Test   (size_t index) const;   // return bit value at index as bool
 
     size_t Size   () const;               // return size of bitvector
     void   Expand (size_t newsize);       // increase number of bits, retaining current values
     void   Dump   (std::ostream& os) const;
-   
+
+    size_t Count     () const;               // number of bits = 1
+    size_t FindFirst () const;               // index of first bit = 1, or Size() if none
+    size_t FindNext  (size_t index) const;   // index of first bit = 1 after index, or Size() if none
+
+    // word-wise boolean operations; b may be shorter or longer than *this
+    void   And    (const BitVector& b);   // bit = bit & b.bit  (bits past b.Size() become 0)
+    void   Or     (const BitVector& b);   // bit = bit | b.bit  (bits past Size() are ignored)
+    void   Xor    (const BitVector& b);   // bit = bit ^ b.bit  (bits past Size() are ignored)
+    void   AndNot (const BitVector& b);   // bit = bit & ~b.bit
+    void   Swap   (BitVector& b);         // exchange contents in O(1)
+
   private:
     // data
-    unsigned char *      byteArray_;
-    size_t               byteArraySize_;
+    uint64_t *           wordArray_;
+    size_t               wordArraySize_;
+    size_t               size_;          // number of bits, a multiple of 8
 
     // methods
-    size_t               ByteNumber (size_t index) const;
-    static unsigned char Mask       (size_t index);
+    size_t               WordNumber (size_t index) const;
+    static uint64_t      Mask       (size_t index);
+    void                 Trim       ();  // zero the bits past size_ in the last word
+    static size_t        PopCount   (uint64_t w);
+    static size_t        LowBit     (uint64_t w);  // index of lowest 1 bit; pre: w != 0
 
   } ; // class BitVector
 
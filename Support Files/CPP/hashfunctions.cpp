@@ -41,6 +41,23 @@
 
     ModP is the classic modular hashing.
 
+    10/18/26: added the Wy and Murmur families. MM and KISS consume one
+    character per step, and every step waits on the previous one. Wy and
+    Murmur read the string 8 bytes at a time and mix with 64-bit multiplies:
+
+    Murmur is Austin Appleby's MurmurHash64A: each 8-byte word is multiplied,
+    shifted and folded into the state, then the tail and a final avalanche.
+
+    Wy is built like Wang Yi's wyhash (final version 4): strings up to 16
+    bytes are read as two overlapping words with no loop at all (about two
+    thirds of the names in movies.txt); longer strings go 16 bytes per step,
+    or 48 in three independent lanes. The mixer is a 64x64 -> 128 bit
+    multiply whose two halves are xor'ed together. Its values are not meant
+    to match other wyhash implementations.
+
+    Words are read with memcpy in native byte order, so both families give
+    different (equally good) values on big-endian machines.
+
     Copyright 2015, R.C. Lacher
 */
 
@@ -247,4 +264,169 @@ namespace hashfunction
     return Crank(bigval);
   }
 
+  // *****************************
+  //      Murmur family
+  // *****************************
+
+  static inline uint64_t Read8 (const char* p)
+  {
+    uint64_t w;
+    memcpy(&w, p, 8);
+    return w;
+  }
+
+  static inline uint64_t Read4 (const char* p)
+  {
+    uint32_t w;
+    memcpy(&w, p, 4);
+    return w;
+  }
+
+  uint64_t Murmur (const char* S, size_t length, uint64_t seed)
+  {
+    const uint64_t m = 0xc6a4a7935bd1e995ULL;
+    const int      r = 47;
+    uint64_t h = seed ^ (length * m);
+    const char* end = S + (length & ~(size_t)7);
+    for (const char* p = S; p != end; p += 8)
+    {
+      uint64_t k = Read8(p);
+      k *= m; k ^= k >> r; k *= m;
+      h ^= k;
+      h *= m;
+    }
+    const unsigned char* t = (const unsigned char*)end;
+    switch (length & 7)
+    {
+      case 7: h ^= (uint64_t)t[6] << 48; // fall through
+      case 6: h ^= (uint64_t)t[5] << 40; // fall through
+      case 5: h ^= (uint64_t)t[4] << 32; // fall through
+      case 4: h ^= (uint64_t)t[3] << 24; // fall through
+      case 3: h ^= (uint64_t)t[2] << 16; // fall through
+      case 2: h ^= (uint64_t)t[1] << 8;  // fall through
+      case 1: h ^= (uint64_t)t[0];
+              h *= m;
+    }
+    h ^= h >> r; h *= m; h ^= h >> r;
+    return h;
+  }
+
+  uint64_t Murmur (const uint64_t& i)
+  {
+    return Murmur((const char*)&i, sizeof(i));
+  }
+
+  uint64_t Murmur (const fsu::String& S)
+  {
+    return Murmur(S.Cstr(), S.Size());
+  }
+
+  uint64_t Murmur (const std::string& S)
+  {
+    return Murmur(S.c_str(), S.size());
+  }
+
+  // *****************************
+  //      Wy family
+  // *****************************
+
+  static const uint64_t wyp0 = 0x2d358dccaa6c78a5ULL;
+  static const uint64_t wyp1 = 0x8bb84b93962eacc9ULL;
+  static const uint64_t wyp2 = 0x4b33a62ed433d4a3ULL;
+  static const uint64_t wyp3 = 0x4d5a2da51de1aa47ULL;
+
+  static inline void WyMum (uint64_t& a, uint64_t& b)
+  // (a,b) = low and high halves of the 128 bit product a * b
+  {
+#if defined(__SIZEOF_INT128__)
+    __uint128_t r = (__uint128_t)a * b;
+    a = (uint64_t)r;
+    b = (uint64_t)(r >> 64);
+#else
+    uint64_t ha = a >> 32, hb = b >> 32, la = (uint32_t)a, lb = (uint32_t)b;
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    uint64_t t = rl + (rm0 << 32), c = t < rl;
+    uint64_t lo = t + (rm1 << 32);
+    c += lo < t;
+    a = lo;
+    b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+  }
+
+  static inline uint64_t WyMix (uint64_t a, uint64_t b)
+  {
+    WyMum(a,b);
+    return a ^ b;
+  }
+
+  uint64_t Wy (const char* S, size_t length, uint64_t seed)
+  {
+    const char* p = S;
+    uint64_t a, b;
+    seed ^= WyMix(seed ^ wyp0, wyp1);
+    if (length <= 16)
+    {
+      if (length >= 4)
+      {
+        size_t q = (length >> 3) << 2; // 0 below 8 bytes, else 4: the two halves overlap
+        a = (Read4(p) << 32) | Read4(p + q);
+        b = (Read4(p + length - 4) << 32) | Read4(p + length - 4 - q);
+      }
+      else if (length > 0)
+      {
+        const unsigned char* u = (const unsigned char*)p;
+        a = ((uint64_t)u[0] << 16) | ((uint64_t)u[length >> 1] << 8) | u[length - 1];
+        b = 0;
+      }
+      else
+        a = b = 0;
+    }
+    else
+    {
+      size_t i = length;
+      if (i >= 48)
+      {
+        uint64_t see1 = seed, see2 = seed;
+        do
+        {
+          seed = WyMix(Read8(p) ^ wyp1, Read8(p + 8) ^ seed);
+          see1 = WyMix(Read8(p + 16) ^ wyp2, Read8(p + 24) ^ see1);
+          see2 = WyMix(Read8(p + 32) ^ wyp3, Read8(p + 40) ^ see2);
+          p += 48; i -= 48;
+        }
+        while (i >= 48);
+        seed ^= see1 ^ see2;
+      }
+      while (i > 16)
+      {
+        seed = WyMix(Read8(p) ^ wyp1, Read8(p + 8) ^ seed);
+        p += 16; i -= 16;
+      }
+      a = Read8(p + i - 16);
+      b = Read8(p + i - 8);
+    }
+    a ^= wyp1;
+    b ^= seed;
+    WyMum(a,b);
+    return WyMix(a ^ wyp0 ^ length, b ^ wyp1);
+  }
+
+  uint64_t Wy (const uint64_t& i)
+  // wyhash64: one multiply-mix round
+  {
+    uint64_t a = i ^ wyp0, b = wyp1;
+    WyMum(a,b);
+    return WyMix(a ^ wyp0, b ^ wyp1);
+  }
+
+  uint64_t Wy (const fsu::String& S)
+  {
+    return Wy(S.Cstr(), S.Size());
+  }
+
+  uint64_t Wy (const std::string& S)
+  {
+    return Wy(S.c_str(), S.size());
+  }
+
 } // namespace hashfunction
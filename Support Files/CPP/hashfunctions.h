@@ -6,6 +6,7 @@
     Prototypes for pure hash functions. Hash classes are defined in hashclasses.h.
 
     11/28/14: added mod prime hashing
+    10/18/26: added Wy and Murmur, word-at-a-time string hashes
 
     The fsu:: and alt:: versions are no longer supported. New clients should write to
     specific hash functions or hash classes. Older clients will need to have
@@ -49,6 +50,16 @@ namespace hashfunction
   uint64_t Simple (const char* s, size_t length);
   uint64_t Simple (const fsu::String & s);
 
+  uint64_t Wy (const uint64_t & i);
+  uint64_t Wy (const char* s, size_t length, uint64_t seed = 0);
+  uint64_t Wy (const fsu::String & s);
+  uint64_t Wy (const std::string & s);
+
+  uint64_t Murmur (const uint64_t & i);
+  uint64_t Murmur (const char* s, size_t length, uint64_t seed = 0);
+  uint64_t Murmur (const fsu::String & s);
+  uint64_t Murmur (const std::string & s);
+
 } // hashfunction
 
 #endif
@@ -14,35 +14,155 @@
 #include <primes.h>
 #include <timer.h>
 #include <iomanip>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <thread>
+#include <atomic>
 
 #include <timer.cpp>
 
 namespace fsu
 {
-  size_t PrimeBelow (size_t n, bool ticker)
-  // returns largest prime number <= n
-  // This is likely to be more efficient than PrimeAbove(), because
-  // it only needs a bitvector of size n+1
+  // growth primes: the first prime >= 1.5 * 2^k, k = 2 .. 62
+  static const uint64_t growthPrimes [] =
   {
-    if (n <= 1) return 0;
-    if (n == 2) return 2;
-    if (n >= n+1)
+    7ULL, 13ULL, 29ULL, 53ULL, 97ULL, 193ULL, 389ULL, 769ULL, 1543ULL, 3079ULL,
+    6151ULL, 12289ULL, 24593ULL, 49157ULL, 98317ULL, 196613ULL, 393241ULL,
+    786433ULL, 1572869ULL, 3145739ULL, 6291469ULL, 12582917ULL, 25165843ULL,
+    50331653ULL, 100663319ULL, 201326611ULL, 402653189ULL, 805306457ULL,
+    1610612741ULL, 3221225473ULL, 6442450967ULL, 12884901893ULL,
+    25769803799ULL, 51539607599ULL, 103079215111ULL, 206158430209ULL,
+    412316860441ULL, 824633720837ULL, 1649267441681ULL, 3298534883417ULL,
+    6597069766657ULL, 13194139533349ULL, 26388279066671ULL,
+    52776558133303ULL, 105553116266509ULL, 211106232533047ULL,
+    422212465066001ULL, 844424930132057ULL, 1688849860263953ULL,
+    3377699720527897ULL, 6755399441055827ULL, 13510798882111519ULL,
+    27021597764223071ULL, 54043195528445957ULL, 108086391056891941ULL,
+    216172782113783843ULL, 432345564227567621ULL, 864691128455135281ULL,
+    1729382256910270481ULL, 3458764513820540933ULL, 6917529027641081903ULL
+  };
+  static const size_t numGrowthPrimes = sizeof(growthPrimes) / sizeof(growthPrimes[0]);
+
+  // a * b mod m without overflow
+  static uint64_t MulMod (uint64_t a, uint64_t b, uint64_t m)
+  {
+#if defined(__SIZEOF_INT128__)
+    return (uint64_t)(((unsigned __int128)a * b) % m);
+#else
+    if (m <= 0xFFFFFFFFULL)
+      return (a * b) % m;
+    uint64_t r = 0; // double and add
+    a %= m;
+    while (b > 0)
+    {
+      if (b & 1)
+        r = (r >= m - a) ? r - (m - a) : r + a;
+      a = (a >= m - a) ? a - (m - a) : a + a;
+      b >>= 1;
+    }
+    return r;
+#endif
+  }
+
+  static uint64_t PowMod (uint64_t a, uint64_t e, uint64_t m)
+  {
+    uint64_t r = 1;
+    a %= m;
+    while (e > 0)
+    {
+      if (e & 1)
+        r = MulMod(r, a, m);
+      a = MulMod(a, a, m);
+      e >>= 1;
+    }
+    return r;
+  }
+
+  bool IsPrime (uint64_t n)
+  // the first 12 prime bases decide every n < 3.3 * 10^24 (Sorenson and Webster)
+  {
+    static const uint64_t bases [] = { 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37 };
+    if (n < 2) return 0;
+    for (size_t i = 0; i < 12; ++i)
+    {
+      if (n % bases[i] == 0)
+        return n == bases[i];
+    }
+    uint64_t d = n - 1;
+    size_t s = 0;
+    while ((d & 1) == 0)
+    {
+      d >>= 1;
+      ++s;
+    }
+    for (size_t i = 0; i < 12; ++i)
     {
-      std::cerr << " ** PrimeBelow: argument too large for implementation. Execution terminating.\n";
-      exit (EXIT_FAILURE);
+      uint64_t x = PowMod(bases[i], d, n);
+      if (x == 1 || x == n - 1)
+        continue;
+      size_t r = 1;
+      for (; r < s; ++r)
+      {
+        x = MulMod(x, x, n);
+        if (x == n - 1)
+          break;
+      }
+      if (r == s) // never reached n - 1: bases[i] witnesses that n is composite
+        return 0;
     }
-    fsu::BitVector b(1+n);
-    Sieve(b, ticker);
-    if (n%2 == 0) --n; // make n odd
-    while (n > 2)
+    return 1;
+  }
+
+  size_t NextPrime (size_t n)
+  {
+    if (n <= 2) return 2;
+    if (n % 2 == 0) ++n;
+    for (; n >= 3; n += 2) // stops if n + 2 wraps around
     {
-      if (b.Test(n))
+      if (IsPrime(n))
+        return n;
+    }
+    return 0;
+  }
+
+  size_t PrevPrime (size_t n)
+  {
+    if (n < 2) return 0;
+    if (n == 2) return 2;
+    if (n % 2 == 0) --n;
+    for (; n > 2; n -= 2)
+    {
+      if (IsPrime(n))
         return n;
-      n -= 2;
     }
     return 2;
   }
 
+  size_t GrowthPrime (size_t n)
+  {
+    size_t lo = 0, hi = numGrowthPrimes; // binary search for the first table prime >= n
+    while (lo < hi)
+    {
+      size_t mid = (lo + hi) / 2;
+      if (growthPrimes[mid] < (uint64_t)n)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+    if (lo < numGrowthPrimes && growthPrimes[lo] == (uint64_t)(size_t)growthPrimes[lo])
+      return (size_t)growthPrimes[lo];
+    return NextPrime(n);
+  }
+
+  size_t PrimeBelow (size_t n, bool)
+  // returns largest prime number <= n
+  // no sieve: a prime is found within O(log n) candidates on average,
+  // each checked by IsPrime
+  {
+    return PrevPrime(n);
+  }
+
   size_t PrimeBelowOpt (size_t n, bool ticker)
   // odd integer version
   {
@@ -63,26 +183,11 @@ namespace fsu
     return 2;
   }
 
-  size_t PrimeAbove (size_t n, bool ticker)
+  size_t PrimeAbove (size_t n, bool)
   // returns smallest prime number >= n
   // or zero if input is too large
   {
-    if (n <= 2) return 2;
-    size_t m = n << 1; // m = 2n 
-    if (m <= n)        // 2n <= n => overflow
-    {
-      return 0;
-    }
-    fsu::BitVector b(m);
-    Sieve(b, ticker);
-
-    while (n < m)
-    {
-      if (b.Test(n))
-        return n;
-      ++n;
-    }
-    return PrimeAbove(m,ticker);
+    return NextPrime(n);
   }
 
   // tested experimental version 
@@ -153,19 +258,272 @@ namespace fsu
   }  // end Sieve()
   // */
 
-  // tested version 2 - ignores all even bits
+  //----------------------------------
+  //     segmented sieve
+  //----------------------------------
+
+  static const size_t segmentSize = 32768; // odd numbers (= bytes) per segment; fits L1
+  static const size_t wheelSize   = 105;   // the odd numbers mod 3 * 5 * 7 * 2 repeat with this period
+
+  // wheel[q] = 0 iff 2q+1 is a multiple of 3, 5 or 7; doubled so that any
+  // rotation of the pattern is one memcpy
+  static unsigned char wheel [2 * wheelSize];
+  static bool          wheelReady = 0;
+
+  static void MakeWheel ()
+  {
+    if (wheelReady) return;
+    for (size_t q = 0; q < 2 * wheelSize; ++q)
+    {
+      size_t m = 2 * (q % wheelSize) + 1;
+      wheel[q] = (m % 3 != 0 && m % 5 != 0 && m % 7 != 0);
+    }
+    wheelReady = 1;
+  }
+
+  // returns a new[]ed array of the odd primes p with p*p < hi
+  static size_t* BasePrimes (size_t hi, size_t& count)
+  {
+    // limit = largest p with p*p < hi
+    size_t limit = (size_t)std::sqrt((double)hi);
+    if (limit > 0xFFFFFFFFULL) limit = 0xFFFFFFFFULL;
+    while (limit > 1 && limit * limit >= hi)
+      --limit;
+    while (limit < 0xFFFFFFFFULL && (limit + 1) * (limit + 1) < hi)
+      ++limit;
+    // odd-only byte sieve of [0, limit]: small[i] codes 2i+1
+    size_t half = limit / 2 + 1;
+    unsigned char* small = new unsigned char [half];
+    memset(small, 1, half);
+    small[0] = 0;
+    for (size_t i = 1; (2*i+1) * (2*i+1) <= limit; ++i)
+      if (small[i])
+        for (size_t j = (2*i+1) * (2*i+1) / 2; j < half; j += 2*i+1)
+          small[j] = 0;
+    size_t* base = new size_t [half];
+    count = 0;
+    for (size_t i = 1; i < half && 2*i+1 <= limit; ++i)
+      if (small[i]) base[count++] = 2*i+1;
+    delete [] small;
+    return base;
+  }
+
+  // post: seg[i] = 1 iff lo + 2i is prime, for i < count
+  // pre:  lo is odd; base holds the odd primes p with p*p < lo + 2*count
+  static void SieveSegment (size_t lo, size_t count, const size_t* base, size_t numBase, unsigned char* seg)
+  {
+    size_t r = ((lo - 1) / 2) % wheelSize;
+    for (size_t i = 0; i < count; i += wheelSize)
+      memcpy(seg + i, wheel + r, (count - i < wheelSize) ? count - i : wheelSize);
+    size_t hi = lo + 2 * count;
+    for (size_t b = 0; b < numBase; ++b)
+    {
+      size_t p = base[b];
+      if (p < 11) continue;        // done by the wheel
+      if (p * p >= hi) break;
+      size_t start = p * p;
+      if (start < lo)
+      {
+        start = (lo + p - 1) / p * p;
+        if (start % 2 == 0) start += p;  // odd multiples only
+      }
+      for (size_t j = (start - lo) / 2; j < count; j += p)
+        seg[j] = 0;
+    }
+    // the wheel struck 3, 5, 7 themselves and kept 1
+    for (size_t m = 1; m <= 7; m += 2)
+      if (m >= lo && m < hi)
+        seg[(m - lo) / 2] = (m != 1);
+  }
+
+  static size_t Threads (size_t threads)
+  {
+    if (threads == 0)
+      threads = std::thread::hardware_concurrency();
+    return threads == 0 ? 1 : threads;
+  }
+
+  // appends " p" to out for every prime p coded in seg
+  static void FormatSegment (size_t lo, size_t count, const unsigned char* seg, std::string& out)
+  {
+    char digits [24];
+    for (size_t i = 0; i < count; ++i)
+    {
+      if (!seg[i]) continue;
+      size_t p = lo + 2 * i, k = sizeof(digits);
+      do { digits[--k] = (char)('0' + p % 10); p /= 10; } while (p > 0);
+      digits[--k] = ' ';
+      out.append(digits + k, sizeof(digits) - k);
+    }
+  }
+
+  PrimeRange::PrimeRange (size_t lo, size_t hi)
+    : hi_(0), next_(0), base_(0), numBase_(0), segment_(new unsigned char [segmentSize]),
+      segLo_(0), segCount_(0), pos_(0), two_(0)
+  {
+    Reset(lo, hi);
+  }
+
+  PrimeRange::~PrimeRange ()
+  {
+    delete [] base_;
+    delete [] segment_;
+  }
+
+  void PrimeRange::Reset (size_t lo, size_t hi)
+  {
+    MakeWheel();
+    delete [] base_;
+    hi_ = (hi < lo) ? lo : hi;
+    base_ = BasePrimes(hi_, numBase_);
+    two_ = (lo <= 2 && 2 < hi_);
+    next_ = (lo < 3) ? 3 : (lo | 1);
+    segLo_ = next_;
+    segCount_ = pos_ = 0;
+  }
+
+  size_t PrimeRange::Next (size_t* primes, size_t max)
+  {
+    size_t k = 0;
+    if (two_ && k < max)
+    {
+      primes[k++] = 2;
+      two_ = 0;
+    }
+    while (k < max)
+    {
+      if (pos_ == segCount_) // segment used up: sieve the next one
+      {
+        if (next_ >= hi_) break;
+        segLo_ = next_;
+        segCount_ = (hi_ - next_ + 1) / 2;
+        if (segCount_ > segmentSize) segCount_ = segmentSize;
+        SieveSegment(segLo_, segCount_, base_, numBase_, segment_);
+        next_ = segLo_ + 2 * segCount_;
+        pos_ = 0;
+      }
+      for (; pos_ < segCount_ && k < max; ++pos_)
+        if (segment_[pos_])
+          primes[k++] = segLo_ + 2 * pos_;
+    }
+    return k;
+  }
+
+  // one thread of CountPrimes: sieves segments until the shared counter runs out
+  static void CountSegments (size_t first, size_t odds, size_t segments, const size_t* base, size_t numBase,
+                             std::atomic<size_t>* next, std::atomic<size_t>* total)
+  {
+    unsigned char* seg = new unsigned char [segmentSize];
+    size_t count = 0;
+    for (size_t s = (*next)++; s < segments; s = (*next)++)
+    {
+      size_t begin = s * segmentSize;
+      size_t n = (odds - begin < segmentSize) ? odds - begin : segmentSize;
+      SieveSegment(first + 2 * begin, n, base, numBase, seg);
+      for (size_t i = 0; i < n; ++i)
+        count += seg[i];
+    }
+    *total += count;
+    delete [] seg;
+  }
+
+  size_t CountPrimes (size_t lo, size_t hi, size_t threads)
+  {
+    if (hi <= lo) return 0;
+    MakeWheel();
+    size_t numBase;
+    size_t* base = BasePrimes(hi, numBase);
+    size_t first = (lo < 3) ? 3 : (lo | 1);
+    size_t odds = (hi > first) ? (hi - first + 1) / 2 : 0;
+    size_t segments = (odds + segmentSize - 1) / segmentSize;
+    std::atomic<size_t> next(0), total((lo <= 2 && 2 < hi) ? 1 : 0);
+
+    threads = Threads(threads);
+    if (threads > segments) threads = segments;
+    std::thread** pool = new std::thread* [threads + 1];
+    for (size_t t = 1; t < threads; ++t)
+      pool[t] = new std::thread(CountSegments, first, odds, segments, base, numBase, &next, &total);
+    CountSegments(first, odds, segments, base, numBase, &next, &total);
+    for (size_t t = 1; t < threads; ++t)
+    {
+      pool[t]->join();
+      delete pool[t];
+    }
+    delete [] pool;
+    delete [] base;
+    return total;
+  }
+
+  // sieves and formats segment s of the odd numbers from 3 into out
+  static void FormatSegments (size_t s, size_t odds, const size_t* base, size_t numBase,
+                              unsigned char* seg, std::string* out)
+  {
+    size_t begin = s * segmentSize;
+    size_t count = (odds - begin < segmentSize) ? odds - begin : segmentSize;
+    size_t lo = 3 + 2 * begin;
+    out->clear();
+    SieveSegment(lo, count, base, numBase, seg);
+    FormatSegment(lo, count, seg, *out);
+  }
+
+  // tested version 3 - segmented: each round, every thread sieves and formats
+  // one segment into its own buffer, and the buffers are written in order
   void AllPrimesBelow (size_t n, std::ostream& os, bool ticker)
   // writes all primes <= n to os
   {
-    if (n < n + 1) // n is not the largest size_t
-      ++n;
-    fsu::BitVector b(n);
-    Sieve(b, ticker);
-    if (n >= 2) os << ' ' << 2;
-    for (size_t i = 3; i < n; i += 2)
-      if (b.Test(i))
-	os << ' ' << i;
+    fsu::Timer timer;
+    fsu::Instant time;
+    if (ticker)
+    {
+      timer.EventReset();
+    }
+    MakeWheel();
+    size_t hi = (n < n + 1) ? n + 1 : n; // n + 1, unless n is the largest size_t
+    size_t numBase;
+    size_t* base = BasePrimes(hi, numBase);
+    size_t odds = (hi > 3) ? (hi - 3 + 1) / 2 : 0;
+    size_t segments = (odds + segmentSize - 1) / segmentSize;
+    size_t threads = Threads(0);
+    std::string* out = new std::string [threads];
+    unsigned char** seg = new unsigned char* [threads];
+    std::thread** pool = new std::thread* [threads];
+    for (size_t t = 0; t < threads; ++t)
+      seg[t] = new unsigned char [segmentSize];
+
+    if (hi > 2) os << ' ' << 2;
+    for (size_t s = 0; s < segments; s += threads)
+    {
+      size_t round = (segments - s < threads) ? segments - s : threads;
+      for (size_t t = 1; t < round; ++t)
+        pool[t] = new std::thread(FormatSegments, s + t, odds, base, numBase, seg[t], out + t);
+      FormatSegments(s, odds, base, numBase, seg[0], out);
+      for (size_t t = 0; t < round; ++t)
+      {
+        if (t > 0)
+        {
+          pool[t]->join();
+          delete pool[t];
+        }
+        os.write(out[t].data(), out[t].size());
+      }
+      if (ticker) std::cout << '.' << std::flush;
+    }
     os << std::endl;
+
+    for (size_t t = 0; t < threads; ++t)
+      delete [] seg[t];
+    delete [] seg;
+    delete [] pool;
+    delete [] out;
+    delete [] base;
+    if (ticker)
+    {
+      time = timer.EventTime();
+      std::cout << '\n';
+      std::cout << " Sieve time: ";
+      time.Write_seconds(std::cout,2);
+      std::cout << " sec\n";
+    }
   }
 
   void Sieve(BitVector& b, bool ticker)
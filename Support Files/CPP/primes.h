@@ -10,6 +10,18 @@
     all use BitVectors, and the first three all call sieve(), an
     implementation of the Sieve of Eratosthenes
 
+    10/18/26: PrimeBelow and PrimeAbove no longer sieve. They search
+    from n with IsPrime, a deterministic Miller-Rabin test, so their cost
+    no longer grows with n. Added NextPrime, PrevPrime and GrowthPrime,
+    the bucket-size policy used by HashTable.
+
+    10/18/26: added PrimeRange and CountPrimes, a segmented sieve with one
+    byte per odd number in 32 KB (L1-sized) segments. Each segment starts
+    as a copy of a wheel pattern that already excludes multiples of 3, 5
+    and 7, and is then crossed off by the base primes up to sqrt(hi).
+    CountPrimes and AllPrimesBelow sieve segments on all cores;
+    AllPrimesBelow formats each segment itself and writes it in one call.
+
     Copyright 2016, R.C. Lacher
 */
 
@@ -17,6 +29,7 @@
 #define _PRIMES_H
 
 #include <iostream>
+#include <cstdint>
 #include <bitvect.h>
 
 namespace fsu
@@ -30,8 +43,54 @@ namespace fsu
   // returns smallest prime number >= n
   // or zero if input is too large
 
+  bool IsPrime (uint64_t n);
+  // deterministic Miller-Rabin: exact for every 64-bit n
+
+  size_t NextPrime (size_t n);
+  // returns smallest prime number >= n
+  // or zero if no such prime fits a size_t
+
+  size_t PrevPrime (size_t n);
+  // returns largest prime number <= n
+  // or zero if n < 2
+
+  size_t GrowthPrime (size_t n);
+  // returns the smallest growth prime >= n: from a precomputed table of
+  // primes near 1.5 * 2^k, each about twice the one before and as far as
+  // possible from a power of two; beyond the table, NextPrime(n)
+
   void AllPrimesBelow (size_t n, std::ostream& os = std::cout, bool ticker = 0);
-  // prints all primes less than n
+  // prints all primes <= n
+
+  size_t CountPrimes (size_t lo, size_t hi, size_t threads = 0);
+  // returns the number of primes p with lo <= p < hi
+  // threads = 0 uses every core
+
+  class PrimeRange
+  // bulk iterator over the primes in [lo, hi), one segment at a time:
+  //   fsu::PrimeRange r(lo, hi);
+  //   size_t buf [1024], k;
+  //   while (0 != (k = r.Next(buf, 1024)))
+  //     ... buf[0] .. buf[k-1], in increasing order ...
+  {
+  public:
+    PrimeRange  (size_t lo, size_t hi);
+    ~PrimeRange ();
+    size_t Next  (size_t* primes, size_t max); // copies up to max primes; 0 when done
+    void   Reset (size_t lo, size_t hi);
+
+  private:
+    PrimeRange (const PrimeRange&);
+    PrimeRange& operator = (const PrimeRange&);
+
+    size_t          hi_;          // end of range
+    size_t          next_;        // odd number at which the next segment starts
+    size_t*         base_;        // odd primes p with p*p < hi
+    size_t          numBase_;
+    unsigned char*  segment_;     // segment_[i] = 1 iff segLo_ + 2i is prime
+    size_t          segLo_, segCount_, pos_;
+    bool            two_;         // 2 is in range and not yet returned
+  };
 
   void Sieve (fsu::BitVector& b, bool ticker = 0);
   // The Sieve of Eratosthenes
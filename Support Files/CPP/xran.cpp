@@ -57,6 +57,21 @@ namespace fsu
       Crank();
   }  
 
+  RandomBase::RandomBase(uint64_t seed) : word_(0)
+  // constructor
+  // repeatable: the same seed always yields the same sequence
+  {
+    Seed(seed);
+  }
+
+  void RandomBase::Seed(uint64_t seed)
+  {
+    word_ = seed;
+    // Crank 7 times to mix up the register
+    for (size_t i = 0; i < 7; ++i) 
+      Crank();
+  }
+
   // Marsaglia KISS 5
   void RandomBase::Crank()
   { 
@@ -344,6 +359,9 @@ namespace fsu
   Random_uint64_t::Random_uint64_t() : RandomBase()
   {}
 
+  Random_uint64_t::Random_uint64_t(uint64_t seed) : RandomBase(seed)
+  {}
+
   uint64_t Random_uint64_t::Get(uint64_t LB, uint64_t UB)
   // returns random int in the interval [LB, UB)
   {
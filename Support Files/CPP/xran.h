@@ -22,6 +22,7 @@
     03/26/12: move to fixed width types defined in stdint.h
     11/11/13: go to C++ style C libraries
     04/04/15: added Random_uint32_t
+    10/18/26: added seeded construction and Seed() for repeatable sequences
 
     about operator () ()
     --------------------
@@ -34,6 +35,16 @@
     Random_int ranint;
     y = ranint(100); // y is a random integer in the range [0, 100)
 
+    about seeds
+    -----------
+
+    By default the generator is seeded from the clock. RandomBase and
+    Random_uint64_t can also be constructed from (or reset to) a given seed,
+    in which case the sequence is the same on every run:
+
+    Random_uint64_t ran(12345);
+    ran.Seed(12345); // restart the same sequence
+
     Copyright 1997 - 2015, R.C. Lacher
 */
 
@@ -55,6 +66,8 @@ namespace fsu
   {
   public:
     RandomBase();
+    explicit RandomBase(uint64_t seed);
+    void Seed(uint64_t seed);  // restarts the sequence determined by seed
     uint64_t Get();  // returns random unsigned 32-bit integer in a 64 bit register
     uint64_t operator () () { return Get(); }
 
@@ -150,6 +163,8 @@ namespace fsu
   {
   public:
     Random_uint64_t();
+    explicit Random_uint64_t(uint64_t seed);
+    using RandomBase::Seed;
     uint64_t Get(uint64_t LB = 0, uint64_t UB = UINT64_MAX);
     // returns random uint64_t in the interval [LB, UB)
     // NOTE: unpredictable result returned if
@@ -28,12 +28,20 @@
     ValueType is not explicitly mentioned in the template (or parameter)
     list for g_heap_sort, but it is needed for the call to g_XC.
 
+    10/18/26: added g_build_heap, Floyd's bottom-up heap construction:
+    sift down every internal node, last to first, in O(n) instead of the
+    O(n log n) of n calls to g_push_heap. g_heap_sort now builds its heap
+    this way and sorts down with the same sift, which moves a "hole" down
+    the tree and places the displaced element once, instead of swapping
+    at every level.
+
 */
 
 #ifndef _GHEAP_H
 #define _GHEAP_H
 
 #include <cstdlib>   // size_t
+#include <type_traits> // std::remove_reference
 
 namespace fsu
 {
@@ -43,6 +51,12 @@ namespace fsu
   template <class I>
   void g_heap_sort (I beg, I end);  // the default order version
 
+  template <class I, class P>
+  void g_build_heap (I beg, I end, P& pred);
+
+  template <class I>
+  void g_build_heap (I beg, I end);  // the default order version
+
   template <class I, class P>
   void g_push_heap (I beg, I end, P& pred);
 
@@ -61,6 +75,57 @@ namespace fsu
 
 namespace fsu
 {
+  namespace heap
+  {
+    // the default order, for the default order versions
+    class Less
+    {
+    public:
+      template <typename T>
+      bool operator () (const T& t1, const T& t2) const { return t1 < t2; }
+    };
+
+    template <class I, class P>
+    void SiftDown (I beg, size_t i, size_t n, P& pred)
+    // Pre:  the subtrees of node i in the range [beg,beg+n) are POTs
+    // Post: the subtree at node i is a POT
+    // beg[i] is lifted out, larger children move up into the hole,
+    // and it is put back once where it belongs
+    {
+      typedef typename std::remove_reference<decltype(*beg)>::type T;
+      T t(beg[i]);
+      size_t c;
+      while ((c = 2*i + 1) < n)     // c = left child
+      {
+        if (c + 1 < n && pred(beg[c],beg[c + 1]))
+          ++c;                      // c = larger child
+        if (!pred(t,beg[c]))
+          break;
+        beg[i] = beg[c];
+        i = c;
+      }
+      beg[i] = t;
+    }
+  } // namespace heap
+
+  template <class I, class P>
+  void g_build_heap (I beg, I end, P& pred)
+  // Floyd's heap construction: O(size)
+  // Post: the range [beg,end) has been permuted and is a POT
+  {
+    size_t n = end - beg;
+    for (size_t i = n/2; i > 0; --i)
+      heap::SiftDown(beg, i - 1, n, pred);
+  }
+
+  template <class I>
+  void g_build_heap (I beg, I end)
+  // the default order version
+  {
+    heap::Less less;
+    fsu::g_build_heap(beg, end, less);
+  }
+
   template <class I, class P>
   void g_heap_sort (I beg, I end, P& pred)
   // Implements heapsort for the iterators
@@ -78,17 +143,15 @@ namespace fsu
     if (end - beg <= 1)
       return;
     size_t size = end - beg;
-    size_t i; 
-    // push elements onto heap one at a time
-    for (i = 1; i < size; ++i)
-    {
-      fsu::g_push_heap(beg, beg + (i + 1), pred);
-    }
-    
-    // keep popping largest remaining element to end of remaining array
-    for (i = size; i > 1; --i)
+    size_t i;
+    // build the heap bottom up
+    fsu::g_build_heap(beg, end, pred);
+
+    // keep moving largest remaining element to end of remaining array
+    for (i = size - 1; i > 0; --i)
     {
-      fsu::g_pop_heap(beg, beg + i, pred);
+      g_XC(beg[0], beg[i]);
+      heap::SiftDown(beg, 0, i, pred);
     }
   } // end g_heap_sort()
 
@@ -96,18 +159,8 @@ namespace fsu
   void g_heap_sort (I beg, I end)
   // the default order version
   {
-    if (end - beg <= 1)
-      return;
-    size_t size = end - beg;
-    size_t i; 
-    for (i = 1; i < size; ++i)
-    {
-      fsu::g_push_heap(beg, beg + (i + 1));
-    }
-    for (i = size; i > 1; --i)
-    {
-      fsu::g_pop_heap(beg, beg + i);
-    }
+    heap::Less less;
+    fsu::g_heap_sort(beg, end, less);
   } // end g_heap_sort()
 
   template <class I, class P>
@@ -0,0 +1,324 @@
+/*
+    gpsort.h
+    10/18/26
+
+    parallel generic algorithms for random access ranges
+
+      g_parallel_for        runs f(0), f(1), ... , f(count-1) on a pool of threads
+      g_parallel_merge      merges two sorted ranges into a third
+      g_parallel_sort       sorts a range: sorted runs, then rounds of parallel merges
+      g_parallel_key_sort   g_key_sort, with the (key, position) pairs sorted in parallel
+
+    Threads: threads = 0 uses every core. The calling thread works too, so
+    threads = 1 runs everything serially, with no thread started.
+
+    Tasks: threads take task numbers from a shared atomic counter, so a
+    thread that finishes early takes the next task instead of waiting.
+
+    Merging: the output of a merge is cut into equal pieces. Each piece
+    finds where it starts in both inputs by binary search along the
+    diagonal (the "merge path"), so pieces merge independently. On ties
+    the first range goes first, so merges are stable.
+
+    Scratch: g_parallel_sort allocates one buffer the size of the range.
+    Each round merges pairs of runs from the range into the buffer or back,
+    and the result is copied home only if the number of rounds is odd.
+
+    Requirements: as g_sort; in addition the comparator and key function
+    are called from several threads at once, so they must not modify
+    shared state, and ValueType must be default constructible for the
+    scratch buffer.
+*/
+
+#ifndef _GPSORT_H
+#define _GPSORT_H
+
+#include <cstdlib>
+#include <atomic>
+#include <thread>
+#include <type_traits> // std::remove_reference
+#include <vector.h>
+#include <gheap.h>     // heap::Less
+#include <gsort.h>     // g_sort, introsort::Keyed, introsort::ByKey, introsort::Permute
+
+namespace fsu
+{
+
+  namespace parallel
+  {
+    const size_t grain = 4096;  // smallest piece worth a task
+
+    inline size_t Threads (size_t threads)
+    {
+      if (threads == 0)
+        threads = std::thread::hardware_concurrency();
+      return threads == 0 ? 1 : threads;
+    }
+
+    template < class F >
+    class TaskRun
+    {
+    public:
+      TaskRun (size_t count, F& f) : count_(count), f_(f), next_(0) {}
+      void Work ()
+      {
+        for (size_t i = next_++; i < count_; i = next_++)
+          f_(i);
+      }
+    private:
+      size_t              count_;
+      F &                 f_;
+      std::atomic<size_t> next_;
+    };
+
+    template < class I1 , class I2 , class Comparator >
+    size_t Split (I1 a, size_t na, I2 b, size_t nb, size_t k, Comparator& cmp)
+    // returns i such that a[0,i) and b[0,k-i) are the first k elements of the stable merge
+    {
+      size_t lo = (k > nb) ? k - nb : 0;
+      size_t hi = (k < na) ? k : na;
+      while (lo < hi)
+      {
+        size_t i = lo + (hi - lo) / 2;
+        size_t j = k - i;
+        if (!cmp(b[j-1],a[i])) // a[i] goes before b[j-1]: take more of a
+          lo = i + 1;
+        else
+          hi = i;
+      }
+      return lo;
+    }
+
+    template < class I1 , class I2 , class O , class Comparator >
+    void MergePiece (I1 a, size_t na, I2 b, size_t nb, O out, size_t lo, size_t hi, Comparator& cmp)
+    // out[lo,hi) = elements lo .. hi-1 of the stable merge of a[0,na) and b[0,nb)
+    {
+      size_t i = Split(a, na, b, nb, lo, cmp);
+      size_t j = lo - i;
+      for (size_t k = lo; k < hi; ++k)
+      {
+        if (j >= nb || (i < na && !cmp(b[j],a[i])))
+          out[k] = a[i++];
+        else
+          out[k] = b[j++];
+      }
+    }
+
+    template < class I1 , class I2 , class O , class Comparator >
+    class MergeTask
+    {
+    public:
+      MergeTask (I1 a, size_t na, I2 b, size_t nb, O out, size_t pieces, Comparator& cmp)
+        : a_(a), b_(b), out_(out), na_(na), nb_(nb), pieces_(pieces), cmp_(cmp) {}
+      void operator () (size_t p)
+      {
+        size_t n = na_ + nb_;
+        MergePiece(a_, na_, b_, nb_, out_, n * p / pieces_, n * (p + 1) / pieces_, cmp_);
+      }
+    private:
+      I1 a_; I2 b_; O out_;
+      size_t na_, nb_, pieces_;
+      Comparator & cmp_;
+    };
+
+    // runs r = 0 .. runs-1 are [Bound(r), Bound(r+1)) with Bound(r) = n * r / runs
+    template < class I , class Comparator >
+    class SortRunTask
+    {
+    public:
+      SortRunTask (I beg, size_t n, size_t runs, Comparator& cmp) : beg_(beg), n_(n), runs_(runs), cmp_(cmp) {}
+      void operator () (size_t r)
+      {
+        g_sort(beg_ + n_ * r / runs_, beg_ + n_ * (r + 1) / runs_, cmp_);
+      }
+    private:
+      I beg_;
+      size_t n_, runs_;
+      Comparator & cmp_;
+    };
+
+    // one round: merges runs 2q*width .. and (2q+1)*width .. of src into dst
+    // output piece p is [n*p/pieces, n*(p+1)/pieces), which may cross pairs
+    template < class S , class D , class Comparator >
+    class MergeRoundTask
+    {
+    public:
+      MergeRoundTask (S src, D dst, size_t n, size_t runs, size_t width, size_t pieces, Comparator& cmp)
+        : src_(src), dst_(dst), n_(n), runs_(runs), width_(width), pieces_(pieces), cmp_(cmp) {}
+      void operator () (size_t p)
+      {
+        size_t lo = n_ * p / pieces_, hi = n_ * (p + 1) / pieces_;
+        for (size_t r = 0; r < runs_; r += 2 * width_)
+        {
+          size_t beg = Bound(r), mid = Bound(r + width_), end = Bound(r + 2 * width_);
+          if (end <= lo) continue;
+          if (hi <= beg) break;
+          size_t plo = (lo > beg) ? lo - beg : 0;
+          size_t phi = ((hi < end) ? hi : end) - beg;
+          MergePiece(src_ + beg, mid - beg, src_ + mid, end - mid, dst_ + beg, plo, phi, cmp_);
+        }
+      }
+    private:
+      size_t Bound (size_t r) const { return (r >= runs_) ? n_ : n_ * r / runs_; }
+      S src_; D dst_;
+      size_t n_, runs_, width_, pieces_;
+      Comparator & cmp_;
+    };
+
+    template < class S , class D >
+    class CopyTask
+    {
+    public:
+      CopyTask (S src, D dst, size_t n, size_t pieces) : src_(src), dst_(dst), n_(n), pieces_(pieces) {}
+      void operator () (size_t p)
+      {
+        size_t lo = n_ * p / pieces_, hi = n_ * (p + 1) / pieces_;
+        for (size_t k = lo; k < hi; ++k)
+          dst_[k] = src_[k];
+      }
+    private:
+      S src_; D dst_;
+      size_t n_, pieces_;
+    };
+
+    template < class I , class KeyFunction >
+    class KeyTask
+    {
+    public:
+      KeyTask (I beg, introsort::Keyed * order, size_t n, size_t pieces, KeyFunction& key)
+        : beg_(beg), order_(order), n_(n), pieces_(pieces), key_(key) {}
+      void operator () (size_t p)
+      {
+        for (size_t k = n_ * p / pieces_; k < n_ * (p + 1) / pieces_; ++k)
+        {
+          order_[k].key_ = key_(beg_[k]);
+          order_[k].pos_ = k;
+        }
+      }
+    private:
+      I beg_;
+      introsort::Keyed * order_;
+      size_t n_, pieces_;
+      KeyFunction & key_;
+    };
+
+    inline size_t Pieces (size_t n, size_t threads)
+    // about four pieces per thread, none smaller than grain
+    {
+      size_t pieces = n / grain;
+      if (pieces > 4 * threads) pieces = 4 * threads;
+      return pieces == 0 ? 1 : pieces;
+    }
+
+  } // namespace parallel
+
+  template < class F >
+  void g_parallel_for (size_t count, F& f, size_t threads = 0)
+  // calls f(i) once for each i in [0,count), in no particular order
+  {
+    threads = parallel::Threads(threads);
+    if (threads > count) threads = count;
+    parallel::TaskRun<F> run(count, f);
+    fsu::Vector<std::thread*> pool;
+    for (size_t t = 1; t < threads; ++t)
+      pool.PushBack(new std::thread(&parallel::TaskRun<F>::Work, &run));
+    run.Work();
+    for (size_t t = 0; t < pool.Size(); ++t)
+    {
+      pool[t]->join();
+      delete pool[t];
+    }
+  }
+
+  template < class I1 , class I2 , class O , class Comparator >
+  void g_parallel_merge (I1 a_beg, I1 a_end, I2 b_beg, I2 b_end, O dest, Comparator& cmp, size_t threads = 0)
+  // pre:  [a_beg,a_end) and [b_beg,b_end) are sorted by cmp; dest has room for both
+  // post: dest[0 .. na+nb) is their stable merge
+  {
+    size_t na = a_end - a_beg, nb = b_end - b_beg;
+    threads = parallel::Threads(threads);
+    size_t pieces = parallel::Pieces(na + nb, threads);
+    parallel::MergeTask<I1,I2,O,Comparator> task(a_beg, na, b_beg, nb, dest, pieces, cmp);
+    g_parallel_for(pieces, task, threads);
+  }
+
+  template < class I1 , class I2 , class O >
+  void g_parallel_merge (I1 a_beg, I1 a_end, I2 b_beg, I2 b_end, O dest, size_t threads = 0)
+  {
+    heap::Less less;
+    g_parallel_merge(a_beg, a_end, b_beg, b_end, dest, less, threads);
+  }
+
+  template < class RAIterator , class Comparator >
+  void g_parallel_sort (RAIterator beg, RAIterator end, Comparator& cmp, size_t threads = 0)
+  // O(size*log(size)) work; NOT stable (the runs are sorted by g_sort)
+  {
+    typedef typename std::remove_reference<decltype(*beg)>::type T;
+    size_t n = end - beg;
+    threads = parallel::Threads(threads);
+    if (threads == 1 || n < 2 * parallel::grain)
+    {
+      g_sort(beg, end, cmp);
+      return;
+    }
+
+    // a power of two runs, at least one per thread, each at least grain long
+    size_t runs = 2;
+    while (runs < threads && n / (2 * runs) >= parallel::grain)
+      runs *= 2;
+    parallel::SortRunTask<RAIterator,Comparator> sortRuns(beg, n, runs, cmp);
+    g_parallel_for(runs, sortRuns, threads);
+
+    fsu::Vector<T> scratch(n);
+    T * buf = scratch.Begin();
+    size_t pieces = parallel::Pieces(n, threads);
+    bool inScratch = 0;
+    for (size_t width = 1; width < runs; width *= 2)
+    {
+      if (inScratch)
+      {
+        parallel::MergeRoundTask<T*,RAIterator,Comparator> round(buf, beg, n, runs, width, pieces, cmp);
+        g_parallel_for(pieces, round, threads);
+      }
+      else
+      {
+        parallel::MergeRoundTask<RAIterator,T*,Comparator> round(beg, buf, n, runs, width, pieces, cmp);
+        g_parallel_for(pieces, round, threads);
+      }
+      inScratch = !inScratch;
+    }
+    if (inScratch)
+    {
+      parallel::CopyTask<T*,RAIterator> copy(buf, beg, n, pieces);
+      g_parallel_for(pieces, copy, threads);
+    }
+  }
+
+  template < class RAIterator >
+  void g_parallel_sort (RAIterator beg, RAIterator end, size_t threads = 0)
+  {
+    heap::Less less;
+    g_parallel_sort(beg, end, less, threads);
+  }
+
+  template < class RAIterator , class KeyFunction , class Comparator >
+  void g_parallel_key_sort (RAIterator beg, RAIterator end, KeyFunction& key, Comparator& cmp, size_t threads = 0)
+  // pre:  key(x) returns a uint64_t such that key(a) < key(b) implies cmp(a,b)
+  // post: the range [beg,end) is ordered by cmp
+  {
+    size_t n = end - beg;
+    if (n < 2) return;
+    threads = parallel::Threads(threads);
+    fsu::Vector<introsort::Keyed> keyed(n);
+    introsort::Keyed * order = keyed.Begin();
+    size_t pieces = parallel::Pieces(n, threads);
+    parallel::KeyTask<RAIterator,KeyFunction> keys(beg, order, n, pieces, key);
+    g_parallel_for(pieces, keys, threads);
+    introsort::ByKey<RAIterator,Comparator> byKey(beg, cmp);
+    g_parallel_sort(order, order + n, byKey, threads);
+    introsort::Permute(beg, order, n);
+  }
+
+} // namespace fsu
+
+#endif
@@ -0,0 +1,203 @@
+/*
+    gradix.h
+    10/18/26
+
+    MSD (most significant digit first) radix sort for ranges of strings
+
+      g_radix_sort (beg, end, rank, threads)
+
+    The elements are string-like: they provide Size() and a const
+    operator [] returning char, as fsu::String does. Digit d of an element
+    is 0 if the element has no character d, and otherwise 1 + rank(s[d]).
+    rank maps each char to a byte, and order of ranks must be the order
+    wanted for chars. The default rank is byte order, as in strcmp,
+    which matches fsu::String's operator < on ASCII. Passing a
+    case-folding rank sorts case insensitively: chars that fold alike
+    share a rank.
+
+    Each level counts digits into 257 buckets and distributes the range
+    stably into them. It then recurses into each bucket at the next depth.
+    A bucket that holds the whole range goes one level deeper without
+    recursing, so long common prefixes cost no stack. Ranges below 32
+    elements are finished by insertion sort, comparing from the current
+    depth. Every element is read once per level, so the work is about
+    proportional to the total length of the distinguishing prefixes
+    rather than n log n comparisons.
+
+    The sort moves positions, not elements. Each level caches its digits
+    in a parallel array, so every string is touched once per level. At
+    the end each element is copied once, to its final place.
+
+    threads > 1 (0 = every core) sorts the buckets of the first character
+    as parallel tasks.
+
+    Strings that compare equal under rank may end in any order.
+*/
+
+#ifndef _GRADIX_H
+#define _GRADIX_H
+
+#include <cstdlib>
+#include <cstdint>
+#include <vector.h>
+#include <gsort.h>     // introsort::Permute
+#include <gpsort.h>    // g_parallel_for
+
+namespace fsu
+{
+
+  namespace radixsort
+  {
+    const size_t cutoff = 32; // insertion sort below this size
+
+    // byte order, as in strcmp
+    class CharOrder
+    {
+    public:
+      uint8_t operator () (char c) const { return (uint8_t)c; }
+    };
+
+    template < class RAIterator , class CharRank >
+    class Sorter
+    {
+    public:
+      Sorter (RAIterator beg, CharRank& rank, size_t * index, size_t * tmp, uint16_t * digit)
+        : beg_(beg), rank_(rank), index_(index), tmp_(tmp), digit_(digit) {}
+
+      void Sort (size_t lo, size_t hi, size_t depth); // sorts index_[lo,hi), whose elements agree below depth
+      void Distribute (size_t lo, size_t hi, size_t depth, size_t * bucket); // one level; bucket[0..257] = bucket bounds
+
+    private:
+      uint16_t Digit (size_t i, size_t depth) const
+      {
+        return (depth < beg_[i].Size()) ? (uint16_t)(1 + rank_(beg_[i][depth])) : 0;
+      }
+      bool Less (size_t a, size_t b, size_t depth) const
+      {
+        for (;; ++depth)
+        {
+          uint16_t da = Digit(a, depth), db = Digit(b, depth);
+          if (da != db) return da < db;
+          if (da == 0) return 0;
+        }
+      }
+
+      RAIterator  beg_;
+      CharRank &  rank_;
+      size_t *    index_;
+      size_t *    tmp_;
+      uint16_t *  digit_;
+    };
+
+    template < class RAIterator , class CharRank >
+    void Sorter<RAIterator,CharRank>::Distribute (size_t lo, size_t hi, size_t depth, size_t * bucket)
+    {
+      size_t next [257];
+      for (size_t c = 0; c < 258; ++c)
+        bucket[c] = 0;
+      for (size_t k = lo; k < hi; ++k)
+      {
+        digit_[k] = Digit(index_[k], depth);
+        ++bucket[digit_[k] + 1];
+      }
+      bucket[0] = lo;
+      for (size_t c = 0; c < 257; ++c)
+      {
+        bucket[c + 1] += bucket[c];
+        next[c] = bucket[c];
+      }
+      for (size_t k = lo; k < hi; ++k)
+        tmp_[next[digit_[k]]++] = index_[k];
+      for (size_t k = lo; k < hi; ++k)
+        index_[k] = tmp_[k];
+    }
+
+    template < class RAIterator , class CharRank >
+    void Sorter<RAIterator,CharRank>::Sort (size_t lo, size_t hi, size_t depth)
+    {
+      size_t bucket [258];
+      for (;; ++depth)
+      {
+        if (hi - lo < cutoff)
+        {
+          for (size_t i = lo + 1; i < hi; ++i)
+          {
+            size_t t = index_[i], j = i;
+            for (; j > lo && Less(t, index_[j-1], depth); --j)
+              index_[j] = index_[j-1];
+            index_[j] = t;
+          }
+          return;
+        }
+        Distribute(lo, hi, depth, bucket);
+        if (bucket[1] == hi)               // all ended: equal
+          return;
+        size_t c = 1;
+        while (bucket[c + 1] == bucket[c]) // find the first non-empty bucket
+          ++c;
+        if (bucket[c + 1] - bucket[c] == hi - lo) // one bucket holds everything: go deeper
+          continue;
+        for (; c < 257; ++c)
+        {
+          if (bucket[c + 1] - bucket[c] > 1)
+            Sort(bucket[c], bucket[c + 1], depth + 1);
+        }
+        return;
+      }
+    }
+
+    // task c sorts bucket c + 1 of the first level
+    template < class RAIterator , class CharRank >
+    class BucketTask
+    {
+    public:
+      BucketTask (Sorter<RAIterator,CharRank>& sorter, const size_t * bucket) : sorter_(sorter), bucket_(bucket) {}
+      void operator () (size_t c)
+      {
+        if (bucket_[c + 2] - bucket_[c + 1] > 1)
+          sorter_.Sort(bucket_[c + 1], bucket_[c + 2], 1);
+      }
+    private:
+      Sorter<RAIterator,CharRank> & sorter_;
+      const size_t *                bucket_;
+    };
+
+  } // namespace radixsort
+
+  template < class RAIterator , class CharRank >
+  void g_radix_sort (RAIterator beg, RAIterator end, CharRank& rank, size_t threads = 1)
+  // post: the range [beg,end) is ordered by the ranks of its characters, shorter first on a common prefix
+  {
+    size_t n = end - beg;
+    if (n < 2) return;
+    fsu::Vector<size_t>   index(n), tmp(n);
+    fsu::Vector<uint16_t> digit(n);
+    size_t * order = index.Begin();
+    for (size_t k = 0; k < n; ++k)
+      order[k] = k;
+    radixsort::Sorter<RAIterator,CharRank> sorter(beg, rank, order, tmp.Begin(), digit.Begin());
+
+    threads = parallel::Threads(threads);
+    if (threads == 1 || n < 2 * parallel::grain)
+      sorter.Sort(0, n, 0);
+    else
+    {
+      size_t bucket [258];
+      sorter.Distribute(0, n, 0, bucket);
+      radixsort::BucketTask<RAIterator,CharRank> task(sorter, bucket);
+      g_parallel_for(256, task, threads);
+    }
+    introsort::Permute(beg, order, n);
+  }
+
+  template < class RAIterator >
+  void g_radix_sort (RAIterator beg, RAIterator end, size_t threads = 1)
+  // the default order version: byte order, as in strcmp
+  {
+    radixsort::CharOrder order;
+    g_radix_sort(beg, end, order, threads);
+  }
+
+} // namespace fsu
+
+#endif
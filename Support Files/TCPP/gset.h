@@ -21,12 +21,21 @@
     A common postcondition is: the output range is sorted (using p where present
     or < otherise)
 
+    g_set_intersection_gallop requires random access iterators I1, I2. It
+    walks the first range and gallops (exponential probe, then binary search)
+    through the second, so it runs in O(n1 log(n2/n1)) and should be called
+    with the shorter range first; it returns the end of the output range.
+    g_set_intersection_size counts the common elements without writing them.
+
     Copyright 2009-13, R. C. Lacher
 */
 
 #ifndef _GSET_H
 #define _GSET_H
 
+#include <gbsearch.h> // g_lower_bound
+#include <compare.h>  // LessThan
+
 namespace fsu
 {
 
@@ -194,6 +203,92 @@ namespace fsu
     }
   }
 
+  template <class I1, class I2, class I3, class P>
+  I3 g_set_intersection_gallop(I1 beg1, I1 end1, I2 beg2, I2 end2, I3 dest, P& p)
+  // range3 = range1 intersection range2, galloping through range2
+  // returns the end of range3
+  {
+    while (beg1 != end1 && beg2 != end2)
+    {
+      // find a window [beg2 + lo, beg2 + hi) that must contain the lower bound of *beg1
+      long n2 = end2 - beg2, lo = 0, hi = 1;
+      while (hi < n2 && p(beg2[hi - 1], *beg1))
+      {
+	lo = hi;
+	hi += hi;
+      }
+      if (hi > n2) hi = n2;
+      beg2 = g_lower_bound(beg2 + lo, beg2 + hi, *beg1, p);
+      if (beg2 == end2)
+	return dest;
+      if (!p(*beg1, *beg2))
+      {
+	*dest++ = *beg1; // *beg1 == *beg2
+	++beg2;
+      }
+      ++beg1;
+    }
+    return dest;
+  }
+
+  template <class I1, class I2, class I3>
+  I3 g_set_intersection_gallop(I1 beg1, I1 end1, I2 beg2, I2 end2, I3 dest)
+  // default order version uses operator <()
+  {
+    fsu::LessThan < typename I2::ValueType > p;
+    return g_set_intersection_gallop(beg1, end1, beg2, end2, dest, p);
+  }
+
+  template <typename T, class I3>
+  I3 g_set_intersection_gallop(const T* beg1, const T* end1, const T* beg2, const T* end2, I3 dest)
+  // specialization for pointers
+  {
+    fsu::LessThan < T > p;
+    return g_set_intersection_gallop(beg1, end1, beg2, end2, dest, p);
+  }
+
+  template <class I1, class I2, class P>
+  size_t g_set_intersection_size(I1 beg1, I1 end1, I2 beg2, I2 end2, P& p)
+  // returns |range1 intersection range2|
+  {
+    size_t count = 0;
+    while (beg1 != end1 && beg2 != end2)
+    {
+      if (p(*beg2,*beg1))
+	++beg2;
+      else if (p(*beg1, *beg2))
+	++beg1;
+      else
+      {
+	++count;
+	++beg1;
+	++beg2;
+      }
+    }
+    return count;
+  }
+
+  template <class I1, class I2>
+  size_t g_set_intersection_size(I1 beg1, I1 end1, I2 beg2, I2 end2)
+  // default order version uses operator <()
+  {
+    size_t count = 0;
+    while (beg1 != end1 && beg2 != end2)
+    {
+      if ((*beg2) < (*beg1))
+	++beg2;
+      else if ((*beg1) < (*beg2))
+	++beg1;
+      else
+      {
+	++count;
+	++beg1;
+	++beg2;
+      }
+    }
+    return count;
+  }
+
   template <class I1, class I2, class I3, class P>
   void g_set_difference(I1 beg1, I1 end1, I2 beg2, I2 end2, I3 dest, P& p)
   // range3 = range1 difference range2 
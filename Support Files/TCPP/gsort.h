@@ -12,15 +12,38 @@
       g_merge_sort_bu
       g_insertion_sort
       // g_quick_sort
+      g_sort
+      g_index_sort
+      g_key_sort
+      g_partial_sort
+      g_nth_element
  
     note that g_heap_sort is located in gheap.h
 
+    10/18/26: g_merge_sort_bu allocates its merge buffer once, not per merge.
+    added g_sort, an introsort: quicksort with a median-of-three
+    pivot, finished by insertion sort below 16 elements, and switching
+    to g_heap_sort when the recursion gets deeper than 2 log2(size), so
+    the worst case is O(size*log(size)). g_index_sort sorts positions
+    instead of elements. g_key_sort sorts (key, position) pairs, where
+    the key is a 64-bit projection of each element consistent with the
+    order, and compares elements only on equal keys. Each element then
+    moves once, to its final place. Use it when elements are expensive
+    to compare or copy, such as strings.
+    added g_partial_sort (the first k in order, by a k-element heap:
+    O(size*log(k))) and g_nth_element (introselect: the quicksort
+    partition, following only the side holding nth; O(size) expected).
+
     Copyright 2016, R. C. Lacher
 */
 
 #include <genalg.h> // Swap, g_copy
 #include <gset.h>   // g_set_merge
+#include <gheap.h>  // g_heap_sort, g_XC
+#include <vector.h>
 #include <debug.h>
+#include <cstdint>
+#include <type_traits> // std::remove_reference
 
 #ifndef _GSORT_H
 #define _GSORT_H
@@ -166,40 +189,313 @@ namespace fsu
       g_copy(B.Begin(), B.End(), beg);
     }
 
+    // merge through a scratch buffer B with room for end - beg elements
+    template < typename RAIterator , typename T , class Comparator >
+    void Merge(RAIterator beg, RAIterator mid, RAIterator end, T* B, Comparator& cmp)
+    {
+      g_set_merge(beg, mid, mid, end, B, cmp);
+      g_copy(B, B + (end - beg), beg);
+    }
+
   } // namespace mergesort
 
+  // one scratch buffer for all merges, allocated once
   template < class RAIterator , class Comparator >
   void g_merge_sort_bu (RAIterator beg, RAIterator end, Comparator& cmp)
   {
+    typedef typename std::remove_reference<decltype(*beg)>::type T;
     size_t n = end - beg;
     if (n < 2) return;
+    fsu::Vector < T > B(n);
     for (size_t i = 1; i < n; i = i+i)
     {
       for (size_t j = 0; j < n - i; j += i+i)
       {
         if (n < j+i+i)
-          mergesort::Merge(beg + j, beg + j+i, end, cmp);
+          mergesort::Merge(beg + j, beg + j+i, end, B.Begin(), cmp);
         else
-          mergesort::Merge(beg + j, beg + j+i, beg + j+i+i, cmp);
+          mergesort::Merge(beg + j, beg + j+i, beg + j+i+i, B.Begin(), cmp);
       }
     }
   }
 
   template < class RAIterator >
   void g_merge_sort_bu (RAIterator beg, RAIterator end)
+  {
+    heap::Less less;
+    g_merge_sort_bu(beg, end, less);
+  }
+
+  namespace introsort
+  {
+    const size_t cutoff = 16; // insertion sort at or below this size
+
+    template < class RAIterator , class Comparator >
+    void InsertionSort (RAIterator beg, size_t n, Comparator& cmp)
+    {
+      typedef typename std::remove_reference<decltype(*beg)>::type T;
+      for (size_t i = 1; i < n; ++i)
+      {
+        if (!cmp(beg[i],beg[i-1]))
+          continue;
+        T t(beg[i]);
+        size_t j = i;
+        do
+        {
+          beg[j] = beg[j-1];
+          --j;
+        }
+        while (j > 0 && cmp(t,beg[j-1]));
+        beg[j] = t;
+      }
+    }
+
+    template < class RAIterator , class Comparator >
+    size_t Partition (RAIterator beg, size_t n, Comparator& cmp)
+    // pre:  n >= 3
+    // post: [0,j] <= pivot <= [j+1,n) for the returned j; both parts are non-empty
+    {
+      typedef typename std::remove_reference<decltype(*beg)>::type T;
+      // order beg[0] <= beg[m] <= beg[n-1]; the ends are then sentinels for the scans
+      size_t m = n/2;
+      if (cmp(beg[m],beg[0]))   g_XC(beg[m],beg[0]);
+      if (cmp(beg[n-1],beg[m]))
+      {
+        g_XC(beg[n-1],beg[m]);
+        if (cmp(beg[m],beg[0])) g_XC(beg[m],beg[0]);
+      }
+
+      // Hoare partition
+      T pivot(beg[m]);
+      size_t i = 0, j = n - 1;
+      for (;;)
+      {
+        while (cmp(beg[i],pivot)) ++i;
+        while (cmp(pivot,beg[j])) --j;
+        if (i >= j) break;
+        g_XC(beg[i],beg[j]);
+        ++i; --j;
+      }
+      return j;
+    }
+
+    inline size_t DepthLimit (size_t n)
+    // 2 floor(log2 n)
+    {
+      size_t depth = 0;
+      for (size_t k = n; k > 1; k >>= 1)
+        depth += 2;
+      return depth;
+    }
+
+    template < class RAIterator , class Comparator >
+    void Sort (RAIterator beg, size_t n, size_t depth, Comparator& cmp)
+    {
+      while (n > cutoff)
+      {
+        if (depth == 0)
+        {
+          g_heap_sort(beg, beg + n, cmp);
+          return;
+        }
+        --depth;
+        size_t j = Partition(beg, n, cmp);
+
+        // recurse into the smaller part, loop on the larger
+        if (j + 1 < n - j - 1)
+        {
+          Sort(beg, j + 1, depth, cmp);
+          beg = beg + (j + 1);
+          n = n - j - 1;
+        }
+        else
+        {
+          Sort(beg + (j + 1), n - j - 1, depth, cmp);
+          n = j + 1;
+        }
+      }
+      InsertionSort(beg, n, cmp);
+    }
+
+    // orders positions by the elements at them
+    template < class RAIterator , class Comparator >
+    class ByPosition
+    {
+    public:
+      ByPosition (RAIterator beg, Comparator& cmp) : beg_(beg), cmp_(cmp) {}
+      template < typename N >
+      bool operator () (const N& a, const N& b) const { return cmp_(beg_[a],beg_[b]); }
+    private:
+      RAIterator    beg_;
+      Comparator &  cmp_;
+    };
+
+    struct Keyed
+    {
+      uint64_t key_;
+      size_t   pos_;
+    };
+
+    // orders keyed positions by key, then by the elements at them
+    template < class RAIterator , class Comparator >
+    class ByKey
+    {
+    public:
+      ByKey (RAIterator beg, Comparator& cmp) : beg_(beg), cmp_(cmp) {}
+      bool operator () (const Keyed& a, const Keyed& b) const
+      {
+        if (a.key_ != b.key_) return a.key_ < b.key_;
+        return cmp_(beg_[a.pos_],beg_[b.pos_]);
+      }
+    private:
+      RAIterator    beg_;
+      Comparator &  cmp_;
+    };
+
+    inline size_t & Position (Keyed & k)  { return k.pos_; }
+    inline size_t & Position (size_t & k) { return k; }
+
+    template < class RAIterator , typename Order >
+    void Permute (RAIterator beg, Order * order, size_t n)
+    // beg[k] = old beg[Position(order[k])], one cycle of the permutation at a time;
+    // each element is copied once (plus one temporary per cycle); order is consumed
+    {
+      typedef typename std::remove_reference<decltype(*beg)>::type T;
+      for (size_t k = 0; k < n; ++k)
+      {
+        if (Position(order[k]) == k)
+          continue;
+        T t(beg[k]);
+        size_t hole = k;
+        while (Position(order[hole]) != k)
+        {
+          size_t next = Position(order[hole]);
+          beg[hole] = beg[next];
+          Position(order[hole]) = hole;
+          hole = next;
+        }
+        beg[hole] = t;
+        Position(order[hole]) = hole;
+      }
+    }
+
+  } // namespace introsort
+
+  template < class RAIterator , class Comparator >
+  void g_sort (RAIterator beg, RAIterator end, Comparator& cmp)
+  // introsort: O(size*log(size)) worst case, in place, NOT stable
   {
     size_t n = end - beg;
     if (n < 2) return;
-    for (size_t i = 1; i < n; i = i+i)
+    introsort::Sort(beg, n, introsort::DepthLimit(n), cmp);
+  }
+
+  template < class RAIterator >
+  void g_sort (RAIterator beg, RAIterator end)
+  {
+    heap::Less less;
+    g_sort(beg, end, less);
+  }
+
+  template < class RAIterator , class IndexIterator , class Comparator >
+  void g_index_sort (RAIterator beg, RAIterator end, IndexIterator index, Comparator& cmp)
+  // pre:  index is the beginning of a range of end - beg integers
+  // post: index[0 .. end-beg) is a permutation of 0 .. end-beg-1 such that
+  //       beg[index[0]] <= beg[index[1]] <= ... ; the range [beg,end) is unchanged
+  {
+    size_t n = end - beg;
+    for (size_t k = 0; k < n; ++k)
+      index[k] = k;
+    introsort::ByPosition<RAIterator,Comparator> byPosition(beg, cmp);
+    g_sort(index, index + n, byPosition);
+  }
+
+  template < class RAIterator , class IndexIterator >
+  void g_index_sort (RAIterator beg, RAIterator end, IndexIterator index)
+  {
+    heap::Less less;
+    g_index_sort(beg, end, index, less);
+  }
+
+  template < class RAIterator , class KeyFunction , class Comparator >
+  void g_key_sort (RAIterator beg, RAIterator end, KeyFunction& key, Comparator& cmp)
+  // pre:  key(x) returns a uint64_t such that key(a) < key(b) implies cmp(a,b)
+  // post: the range [beg,end) is ordered by cmp
+  {
+    size_t n = end - beg;
+    if (n < 2) return;
+    fsu::Vector<introsort::Keyed> keyed(n);
+    introsort::Keyed * order = keyed.Begin();
+    for (size_t k = 0; k < n; ++k)
     {
-      for (size_t j = 0; j < n - i; j += i+i)
+      order[k].key_ = key(beg[k]);
+      order[k].pos_ = k;
+    }
+    introsort::ByKey<RAIterator,Comparator> byKey(beg, cmp);
+    g_sort(order, order + n, byKey);
+    introsort::Permute(beg, order, n);
+  }
+
+  template < class RAIterator , class Comparator >
+  void g_partial_sort (RAIterator beg, RAIterator middle, RAIterator end, Comparator& cmp)
+  // post: [beg,middle) holds the middle - beg smallest elements, in order;
+  //       [middle,end) holds the rest, in no particular order
+  {
+    size_t k = middle - beg, n = end - beg;
+    if (k == 0) return;
+    g_build_heap(beg, middle, cmp);   // max heap of the best k so far
+    for (size_t i = k; i < n; ++i)
+    {
+      if (cmp(beg[i],beg[0]))
       {
-        if (n < j+i+i)
-          mergesort::Merge(beg + j, beg + j+i, end);
-        else
-          mergesort::Merge(beg + j, beg + j+i, beg + j+i+i);
+        g_XC(beg[0],beg[i]);
+        heap::SiftDown(beg, 0, k, cmp);
       }
     }
+    for (size_t i = k - 1; i > 0; --i)
+    {
+      g_XC(beg[0],beg[i]);
+      heap::SiftDown(beg, 0, i, cmp);
+    }
+  }
+
+  template < class RAIterator >
+  void g_partial_sort (RAIterator beg, RAIterator middle, RAIterator end)
+  {
+    heap::Less less;
+    g_partial_sort(beg, middle, end, less);
+  }
+
+  template < class RAIterator , class Comparator >
+  void g_nth_element (RAIterator beg, RAIterator nth, RAIterator end, Comparator& cmp)
+  // post: *nth is the element that would be there if the range were sorted;
+  //       [beg,nth) <= *nth <= (nth,end)
+  {
+    size_t lo = 0, hi = end - beg, k = nth - beg;
+    if (k >= hi) return;
+    size_t depth = introsort::DepthLimit(hi);
+    while (hi - lo > introsort::cutoff)
+    {
+      if (depth == 0)
+      {
+        g_partial_sort(beg + lo, beg + (k + 1), beg + hi, cmp); // [lo,k] sorted, the smallest of [lo,hi)
+        return;
+      }
+      --depth;
+      size_t j = lo + introsort::Partition(beg + lo, hi - lo, cmp);
+      if (k <= j)
+        hi = j + 1;
+      else
+        lo = j + 1;
+    }
+    introsort::InsertionSort(beg + lo, hi - lo, cmp);
+  }
+
+  template < class RAIterator >
+  void g_nth_element (RAIterator beg, RAIterator nth, RAIterator end)
+  {
+    heap::Less less;
+    g_nth_element(beg, nth, end, less);
   }
 
 } // namespace 
@@ -4,6 +4,7 @@
     Chris Lacher
 
     11/28/14: added ModP
+    10/18/26: added Wy and Murmur
 
     Definitions and implementations for hash function classes
 
@@ -77,6 +78,22 @@ namespace hashclass
     const char* Name() const {return "Simple";}
   };
 
+  template < typename T >
+  class Murmur
+  {
+  public:
+    uint64_t operator() (const T& t) const { return hashfunction::Murmur(t); }
+    const char* Name() const {return "Murmur";}
+  };
+
+  template < typename T >
+  class Wy
+  {
+  public:
+    uint64_t operator() (const T& t) const { return hashfunction::Wy(t); }
+    const char* Name() const {return "Wy";}
+  };
+
 } // namespace hashclass
 
 #endif